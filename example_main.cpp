@@ -1,5 +1,6 @@
 #include "utils/utils.h"
 
+#include <random>
 #include <vector>
 #include <unordered_map>
 
@@ -49,5 +50,49 @@ int main() {
     utils::printlog("It takes", timeIt.elapsed() / 100000, "seconds to calcuate their bounding box", bound);
     utils::printlog("The above runtime is the average of", 100000, "runs");
 
+    // 5. quadtree vs linear scan on clustered boxes (dense clusters in a mostly empty die)
+    utils::printlog();
+    std::mt19937 rng(0);
+    std::normal_distribution<double> offset(0, 2000);
+    std::uniform_int_distribution<int> coord(0, 10000000), size(10, 200);
+    std::vector<utils::BoxT<int>> boxes;
+    for (int cluster = 0; cluster < 50; ++cluster) {
+        int cx = coord(rng), cy = coord(rng);
+        for (int i = 0; i < 4000; ++i) {
+            int x = cx + static_cast<int>(offset(rng)), y = cy + static_cast<int>(offset(rng));
+            boxes.emplace_back(x, y, x + size(rng), y + size(rng));
+        }
+    }
+    std::vector<utils::PointT<int>> queryPts;
+    for (int i = 0; i < 1000; ++i) {
+        const auto& box = boxes[rng() % boxes.size()];
+        queryPts.emplace_back(box.lx() + size(rng), box.ly() + size(rng));  // where the data is
+    }
+    timeIt.start();
+    utils::QuadtreeT<int> tree(boxes);
+    utils::printlog("Quadtree over", boxes.size(), "clustered boxes:", tree.numNodes(), "nodes, built in",
+                    timeIt.elapsed(), "seconds");
+    size_t numTreeHits = 0, numScanHits = 0;
+    long long treeDist = 0, scanDist = 0;
+    timeIt.start();
+    for (const auto& pt : queryPts) {
+        numTreeHits += tree.Query({pt.x - 1000, pt.y - 1000, pt.x + 1000, pt.y + 1000}).size();
+        treeDist += utils::Dist(boxes[tree.Nearest(pt)], pt);
+    }
+    double treeTime = timeIt.elapsed();
+    timeIt.start();
+    for (const auto& pt : queryPts) {
+        utils::BoxT<int> window(pt.x - 1000, pt.y - 1000, pt.x + 1000, pt.y + 1000);
+        int minDist = std::numeric_limits<int>::max();
+        for (const auto& box : boxes) {
+            numScanHits += box.HasIntersectWith(window);
+            minDist = std::min(minDist, utils::Dist(box, pt));
+        }
+        scanDist += minDist;
+    }
+    double scanTime = timeIt.elapsed();
+    utils::printlog(queryPts.size(), "window + nearest queries take", treeTime, "seconds by quadtree and", scanTime,
+                    "seconds by linear scan, same results:", numTreeHits == numScanHits && treeDist == scanDist);
+
     return 0;
 }
\ No newline at end of file
@@ -2,6 +2,12 @@
 #include "catch.hpp"
 #include "utils/utils.h"
 
+#include <functional>
+#include <map>
+#include <set>
+#include <tuple>
+#include <unordered_set>
+
 using namespace utils;
 using namespace std;
 
@@ -11,8 +17,30 @@ TEST_CASE("Point", "[pt]") {
 
     SECTION("point distance") {
         REQUIRE(Dist(pt1, pt2) == 30);
+        REQUIRE(PointT<int>(3) == PointT<int>(3, InfCoord<int>()));
+        REQUIRE(!std::is_convertible<int, PointT<int>>::value);
         REQUIRE(L2Dist(pt1, pt2) == sqrt(500));
         REQUIRE(LInfDist(pt1, pt2) == 20);
+        REQUIRE(SquaredL2Dist(PointT<int>(-1500000000, 0), PointT<int>(1500000000, 0)) == 9000000000000000000LL);
+    }
+
+    SECTION("orientation predicates") {
+        PointT<int> o(0, 0), a(1000000000, 1), b(-1000000000, 1);
+        REQUIRE(Cross(o, a, b) == 2000000000LL);
+        REQUIRE(Orientation(o, a, b) == 1);
+        REQUIRE(Orientation(o, b, a) == -1);
+        REQUIRE(Orientation(o, a, PointT<int>(-1000000000, -1)) == 0);
+        REQUIRE(Dot(o, a, b) == -999999999999999999LL);
+        REQUIRE(IsOnSegment(PointT<int>(1, 1), PointT<int>(0, 0), PointT<int>(2, 2)));
+        REQUIRE(!IsOnSegment(PointT<int>(3, 3), PointT<int>(0, 0), PointT<int>(2, 2)));
+        REQUIRE(IsSegmentIntersect(PointT<int>(0, 0), PointT<int>(2, 2), PointT<int>(0, 2), PointT<int>(2, 0)));
+        REQUIRE(IsSegmentIntersect(PointT<int>(0, 0), PointT<int>(2, 0), PointT<int>(2, 0), PointT<int>(3, 0)));
+        REQUIRE(!IsSegmentIntersect(PointT<int>(0, 0), PointT<int>(2, 0), PointT<int>(3, 0), PointT<int>(4, 0)));
+        REQUIRE(!IsSegmentIntersect(PointT<int>(0, 0), PointT<int>(2, 2), PointT<int>(0, 1), PointT<int>(1, 2)));
+        PointT<unsigned> uo(10, 10), ua(20, 10), ub(20, 0);
+        REQUIRE(Cross(uo, ua, ub) == -100);
+        REQUIRE(Orientation(uo, ua, ub) == -1);
+        REQUIRE(Cross(PointT<uint64_t>(10, 10), PointT<uint64_t>(20, 10), PointT<uint64_t>(20, 0)) < 0);
     }
 }
 
@@ -106,6 +134,26 @@ TEST_CASE("Box", "[box]") {
         REQUIRE(L2Dist(boxA, boxC) == 8);
     }
 
+    SECTION("box wide area/hp") {
+        BoxT<int> die(-1500000000, -1000000000, 1500000000, 2000000000);
+        REQUIRE(die.area() == 9000000000000000000LL);
+        REQUIRE(die.hp() == 6000000000LL);
+        REQUIRE(SegmentT<int>(-1500000000, 0, 1500000000, 0).length() == 3000000000LL);
+        REQUIRE(UnionArea(vector<BoxT<int>>{die, boxA}) == die.area());
+        REQUIRE(SquaredL2Dist(BoxT<int>(-2000000000, 0, -1000000000, 0), BoxT<int>(1000000000, 0, 2000000000, 0)) ==
+                4000000000000000000LL);
+    }
+
+    SECTION("constexpr box") {
+        // a compile-time table
+        constexpr BoxT<int> table[] = {{0, 0, 2, 2}, {1, 1, 4, 3}, {PointT<int>(5, 5), PointT<int>(6, 7)}};
+        constexpr BoxT<int> bound = table[0].UnionWith(table[1]).UnionWith(table[2]);
+        static_assert(bound == BoxT<int>(0, 0, 6, 7), "");
+        static_assert(table[0].IntersectWith(table[1]).area() == 1 && !table[0].HasIntersectWith(table[2]), "");
+        static_assert(Dist(table[0], table[2]) == 6 && !BoxT<int>().IsValid(), "");
+        REQUIRE(bound.hp() == 13);
+    }
+
     BoxT<int> boxD(5, 6, 15, 16);
     BoxT<int> boxE(9, 100, 10, 102);
 
@@ -114,4 +162,1445 @@ TEST_CASE("Box", "[box]") {
         SlicePolygons(boxes, 1);
         REQUIRE(boxes.size() == 6);
     }
-}
\ No newline at end of file
+}
+TEST_CASE("Dbscan", "[cluster]") {
+    SECTION("dbscan small") {
+        vector<PointT<int>> pts = {{0, 0}, {1, 0}, {0, 1}, {10, 10}, {11, 10}, {11, 11}, {50, 50}, {2, 0}};
+        auto result = Dbscan(pts, 1, 3, DistMetric::L1);
+        REQUIRE(result.numClusters() == 2);
+        REQUIRE(result.labels == vector<int>({0, 0, 0, 1, 1, 1, -1, 0}));
+        REQUIRE(result.clusterBoxes[0] == BoxT<int>(0, 0, 2, 1));
+        REQUIRE(result.clusterBoxes[1] == BoxT<int>(10, 10, 11, 11));
+    }
+
+    SECTION("dbscan vs brute force") {
+        vector<PointT<int>> pts;
+        for (int i = 0; i < 2000; ++i) pts.emplace_back((i * 7919) % 503, (i * 104729) % 499);
+        for (auto metric : {DistMetric::L1, DistMetric::L2, DistMetric::LInf}) {
+            auto result = Dbscan(pts, 15, 4, metric, 4);
+            // brute force: core points in the same cluster iff connected through core points within eps
+            int n = pts.size();
+            vector<int> isCore(n), comp(n, -1);
+            for (int i = 0; i < n; ++i) {
+                int num = 0;
+                for (int j = 0; j < n; ++j) num += IsWithinDist(pts[i], pts[j], 15, metric);
+                isCore[i] = num >= 4;
+            }
+            for (int i = 0; i < n; ++i) {
+                if (!isCore[i] || comp[i] != -1) continue;
+                vector<int> stack = {i};
+                comp[i] = i;
+                while (!stack.empty()) {
+                    int u = stack.back();
+                    stack.pop_back();
+                    for (int v = 0; v < n; ++v) {
+                        if (isCore[v] && comp[v] == -1 && IsWithinDist(pts[u], pts[v], 15, metric)) {
+                            comp[v] = i;
+                            stack.push_back(v);
+                        }
+                    }
+                }
+            }
+            map<int, int> compToLabel, labelToComp;
+            for (int i = 0; i < n; ++i) {
+                if (!isCore[i]) {
+                    for (int j = 0; j < n && comp[i] == -1; ++j) {
+                        if (isCore[j] && IsWithinDist(pts[i], pts[j], 15, metric)) comp[i] = comp[j];
+                    }
+                }
+                REQUIRE((result.labels[i] == -1) == (comp[i] == -1));
+                if (comp[i] == -1) continue;
+                // one-to-one correspondence between clusters
+                REQUIRE(compToLabel.emplace(comp[i], result.labels[i]).first->second == result.labels[i]);
+                REQUIRE(labelToComp.emplace(result.labels[i], comp[i]).first->second == comp[i]);
+                REQUIRE(result.clusterBoxes[result.labels[i]].x.Contain(pts[i].x));
+            }
+        }
+    }
+}
+
+TEST_CASE("Kmeans", "[cluster]") {
+    SECTION("kmeans separated blobs") {
+        vector<PointT<int>> pts;
+        vector<PointT<int>> centers = {{0, 0}, {1000, 0}, {0, 1000}, {1000, 1000}};
+        for (int i = 0; i < 4000; ++i) {
+            const auto& center = centers[i % 4];
+            pts.emplace_back(center.x + (i * 37) % 21 - 10, center.y + (i * 53) % 21 - 10);
+        }
+        auto result = Kmeans(pts, 4, 100, 1, 42, 3);
+        REQUIRE(result.centers.size() == 4);
+        REQUIRE(result.numIters <= 100);
+        for (int i = 0; i < pts.size(); ++i) {
+            REQUIRE(result.labels[i] == result.labels[i % 4]);
+            const auto& center = result.centers[result.labels[i]];
+            REQUIRE(L2Dist(center, PointT<double>(centers[i % 4].x, centers[i % 4].y)) < 2);
+        }
+    }
+
+    SECTION("kmeans degenerate input") {
+        vector<PointT<double>> pts = {{1, 1}, {1, 1}, {2, 2}};
+        auto result = Kmeans(pts, 5);
+        REQUIRE(result.centers.size() == 3);
+        REQUIRE(result.labels[0] == result.labels[1]);
+        REQUIRE(Kmeans(vector<PointT<double>>(), 3).centers.empty());
+    }
+}
+
+TEST_CASE("BoxSet", "[boxset]") {
+    vector<BoxT<int>> boxes;
+    for (int i = 0; i < 300; ++i) {
+        int x = (i * 7919) % 97, y = (i * 104729) % 89;
+        boxes.emplace_back(x, y, x + 1 + (i * 31) % 7, y + 1 + (i * 17) % 5);
+    }
+    // brute-force coverage of unit cells
+    auto cellCount = [](const vector<BoxT<int>>& bs) {
+        set<pair<int, int>> cells;
+        for (const auto& b : bs)
+            for (int x = b.lx(); x < b.hx(); ++x)
+                for (int y = b.ly(); y < b.hy(); ++y) cells.emplace(x, y);
+        return cells;
+    };
+
+    SECTION("bloat/shrink boxes") {
+        vector<BoxT<int>> bs = {{0, 0, 4, 4}, {10, 10, 11, 12}};
+        BloatBoxes(bs, 1);
+        REQUIRE(bs == vector<BoxT<int>>({{-1, -1, 5, 5}, {9, 9, 12, 13}}));
+        BloatBoxes(bs, -2);
+        REQUIRE(bs == vector<BoxT<int>>({{1, 1, 3, 3}}));
+        BloatBoxes(bs, -1);
+        REQUIRE(bs.empty());
+    }
+
+    SECTION("bloat/shrink box sets") {
+        // touching slices shrink as one shape
+        REQUIRE(BloatBoxSet(vector<BoxT<int>>({{0, 0, 10, 10}, {10, 0, 20, 10}}), -2) ==
+                vector<BoxT<int>>({{2, 2, 18, 8}}));
+        REQUIRE(BloatBoxSet(vector<BoxT<int>>({{0, 0, 3, 3}}), -2).empty());
+        REQUIRE(ComplementBoxes(vector<BoxT<int>>({{2, 2, 4, 4}, {0, 0, 1, 6}}), BoxT<int>(0, 0, 6, 6)) ==
+                vector<BoxT<int>>({{1, 0, 2, 6}, {2, 0, 4, 2}, {2, 4, 4, 6}, {4, 0, 6, 6}}));
+        auto cells = cellCount(boxes);
+        for (int amount : {-2, -1, 0, 1, 3}) {
+            auto sized = BloatBoxSet(boxes, amount);
+            set<pair<int, int>> expected;
+            for (int x = -5; x < 110; ++x) {
+                for (int y = -5; y < 100; ++y) {
+                    // bloat: some covered cell within amount, shrink: all cells within -amount are covered
+                    int d = abs(amount), numCovered = 0;
+                    for (int dx = -d; dx <= d; ++dx)
+                        for (int dy = -d; dy <= d; ++dy) numCovered += cells.count({x + dx, y + dy});
+                    if (amount >= 0 ? numCovered > 0 : numCovered == (2 * d + 1) * (2 * d + 1)) expected.emplace(x, y);
+                }
+            }
+            REQUIRE(cellCount(sized) == expected);
+            REQUIRE(UnionArea(sized) == expected.size());
+        }
+    }
+
+    SECTION("union boxes") {
+        auto merged = UnionBoxes(boxes);
+        REQUIRE(cellCount(merged) == cellCount(boxes));
+        for (int i = 0; i < merged.size(); ++i) {
+            REQUIRE(merged[i].IsStrictValid());
+            for (int j = 0; j < i; ++j) REQUIRE(!merged[i].HasStrictIntersectWith(merged[j]));
+        }
+        REQUIRE(UnionArea(boxes) == cellCount(boxes).size());
+        REQUIRE(UnionArea(merged) == cellCount(boxes).size());
+        REQUIRE(UnionBoxes(vector<BoxT<int>>({{0, 0, 2, 2}, {2, 0, 4, 2}})) == vector<BoxT<int>>({{0, 0, 4, 2}}));
+    }
+
+    SECTION("spacing violations") {
+        for (auto metric : {DistMetric::L1, DistMetric::L2, DistMetric::LInf}) {
+            for (bool includeTouching : {false, true}) {
+                auto violations = FindSpacingViolations(boxes, 3, metric, includeTouching);
+                sort(violations.begin(), violations.end());
+                vector<pair<int, int>> expected;
+                for (int i = 0; i < boxes.size(); ++i) {
+                    for (int j = i + 1; j < boxes.size(); ++j) {
+                        if (!includeTouching && boxes[i].HasIntersectWith(boxes[j])) continue;
+                        double dx = Dist(boxes[i].x, boxes[j].x), dy = Dist(boxes[i].y, boxes[j].y);
+                        double dist = metric == DistMetric::L1 ? dx + dy
+                                                               : metric == DistMetric::L2 ? sqrt(dx * dx + dy * dy)
+                                                                                          : max(dx, dy);
+                        if (dist < 3) expected.emplace_back(i, j);
+                    }
+                }
+                REQUIRE(violations == expected);
+            }
+        }
+        // tall boxes (e.g., power stripes) among small ones
+        vector<BoxT<int>> mixed = boxes;
+        mixed.emplace_back(20, -10, 22, 100);
+        mixed.emplace_back(50, 0, 51, 60);
+        mixed.emplace_back(-10, 40, 110, 41);
+        auto violations = FindSpacingViolations(mixed, 2);
+        sort(violations.begin(), violations.end());
+        vector<pair<int, int>> expected;
+        for (int i = 0; i < mixed.size(); ++i) {
+            for (int j = i + 1; j < mixed.size(); ++j) {
+                if (!mixed[i].HasIntersectWith(mixed[j]) && IsCloserThan(mixed[i], mixed[j], 2, DistMetric::LInf)) {
+                    expected.emplace_back(i, j);
+                }
+            }
+        }
+        REQUIRE(violations == expected);
+    }
+}
+
+TEST_CASE("FreeSpace", "[freespace]") {
+    BoxT<int> region(0, 0, 20, 16);
+    vector<BoxT<int>> obstacles;
+    for (int i = 0; i < 14; ++i) {
+        int x = (i * 7919) % 19, y = (i * 104729) % 15;
+        obstacles.emplace_back(x, y, x + 1 + (i * 31) % 4, y + 1 + (i * 17) % 3);
+    }
+    auto isEmpty = [&](const BoxT<int>& box) {
+        if (!region.IntersectWith(box).IsStrictValid() || region.IntersectWith(box) != box) return false;
+        for (const auto& obstacle : obstacles)
+            if (obstacle.HasStrictIntersectWith(box)) return false;
+        return true;
+    };
+
+    SECTION("box grid index") {
+        BoxGridIndexT<int> index(obstacles);
+        BoxT<int> window(3, 4, 11, 9);
+        vector<int> found, expected;
+        index.Query(window, [&](int i) { found.push_back(i); });
+        for (int i = 0; i < obstacles.size(); ++i)
+            if (obstacles[i].HasIntersectWith(window)) expected.push_back(i);
+        sort(found.begin(), found.end());
+        REQUIRE(found == expected);
+    }
+
+    SECTION("maximal empty rects vs brute force") {
+        auto rects = MaximalEmptyRects(region, obstacles);
+        auto toTuple = [](const BoxT<int>& box) { return make_tuple(box.lx(), box.ly(), box.hx(), box.hy()); };
+        sort(rects.begin(), rects.end(), [&](const BoxT<int>& lhs, const BoxT<int>& rhs) {
+            return toTuple(lhs) < toTuple(rhs);
+        });
+        vector<BoxT<int>> expected;
+        for (int lx = 0; lx <= 20; ++lx)
+            for (int ly = 0; ly <= 16; ++ly)
+                for (int hx = lx + 1; hx <= 20; ++hx)
+                    for (int hy = ly + 1; hy <= 16; ++hy) {
+                        BoxT<int> box(lx, ly, hx, hy);
+                        if (isEmpty(box) && !isEmpty({lx - 1, ly, hx, hy}) && !isEmpty({lx, ly - 1, hx, hy}) &&
+                            !isEmpty({lx, ly, hx + 1, hy}) && !isEmpty({lx, ly, hx, hy + 1})) {
+                            expected.push_back(box);
+                        }
+                    }
+        REQUIRE(rects == expected);
+    }
+
+    SECTION("find free box") {
+        FreeSpaceFinderT<int> finder(region, obstacles);
+        for (int w = 1; w <= 6; ++w) {
+            for (PointT<int> pt : {PointT<int>(0, 0), PointT<int>(9, 7), PointT<int>(19, 15)}) {
+                auto result = finder.FindFreeBox(pt, w, 3);
+                int bestDist = numeric_limits<int>::max();
+                for (int x = 0; x + w <= 20; ++x)
+                    for (int y = 0; y + 3 <= 16; ++y)
+                        if (isEmpty({x, y, x + w, y + 3})) bestDist = min(bestDist, Dist(pt, PointT<int>(x, y)));
+                REQUIRE(result.freeBox.IsValid() == (bestDist != numeric_limits<int>::max()));
+                if (!result.freeBox.IsValid()) continue;
+                REQUIRE(isEmpty(result.freeBox));
+                REQUIRE(result.freeBox.IntersectWith(result.placement) == result.placement);
+                REQUIRE(result.placement.width() == w);
+                REQUIRE(Dist(pt, PointT<int>(result.placement.lx(), result.placement.ly())) == bestDist);
+            }
+        }
+        REQUIRE(!finder.FindFreeBox({5, 5}, 30, 1).freeBox.IsValid());
+    }
+
+    SECTION("degenerated region and small coordinates") {
+        FreeSpaceFinderT<int> flat({0, 5, 20, 5}, {});
+        REQUIRE(!flat.FindFreeBox({3, 5}, 0, 0).freeBox.IsValid());
+        FreeSpaceFinderT<int> point({3, 3, 3, 3}, obstacles);
+        REQUIRE(!point.FindFreeBox({3, 3}, 0, 0).freeBox.IsValid());
+
+        vector<BoxT<double>> small;
+        for (const auto& box : obstacles) {
+            small.emplace_back(box.lx() * 1e-3, box.ly() * 1e-3, box.hx() * 1e-3, box.hy() * 1e-3);
+        }
+        FreeSpaceFinderT<double> finder({0, 0, 0.02, 0.016}, small);
+        auto result = finder.FindFreeBox({0.009, 0.007}, 0.002, 0.003);
+        REQUIRE(result.freeBox.IsValid());
+        REQUIRE(result.placement.width() == Approx(0.002));
+        for (const auto& box : small) REQUIRE(!box.HasStrictIntersectWith(result.placement));
+    }
+}
+
+TEST_CASE("RectPartition", "[partition]") {
+    // exact minimum partition of a small cell set by backtracking
+    function<int(vector<vector<int>>&, int)> bruteForce = [&](vector<vector<int>>& grid, int bound) {
+        int n = grid.size(), m = grid[0].size();
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < m; ++j) {
+                if (!grid[i][j]) continue;
+                if (bound <= 1) return 1000;
+                int best = 1000;
+                for (int w = 1; j + w <= m && grid[i][j + w - 1]; ++w) {
+                    for (int h = 1; i + h <= n; ++h) {
+                        bool isFull = true;
+                        for (int k = 0; k < w; ++k) isFull = isFull && grid[i + h - 1][j + k];
+                        if (!isFull) break;
+                        for (int r = i; r < i + h; ++r)
+                            for (int k = j; k < j + w; ++k) grid[r][k] = 0;
+                        best = min(best, 1 + bruteForce(grid, min(bound, best) - 1));
+                        for (int r = i; r < i + h; ++r)
+                            for (int k = j; k < j + w; ++k) grid[r][k] = 1;
+                    }
+                }
+                return best;
+            }
+        }
+        return 0;
+    };
+    auto cellsOf = [](const vector<BoxT<int>>& boxes) {
+        multiset<pair<int, int>> cells;
+        for (const auto& b : boxes)
+            for (int x = b.lx(); x < b.hx(); ++x)
+                for (int y = b.ly(); y < b.hy(); ++y) cells.emplace(x, y);
+        return cells;
+    };
+
+    SECTION("partition of known shapes") {
+        vector<BoxT<int>> frame = {{0, 0, 10, 2}, {0, 8, 10, 10}, {0, 0, 2, 10}, {8, 0, 10, 10}};
+        PartitionPolygons(frame);
+        REQUIRE(frame.size() == 4);
+        vector<BoxT<int>> cross = {{0, 4, 12, 8}, {4, 0, 8, 12}};
+        PartitionPolygons(cross);
+        REQUIRE(cross.size() == 3);
+        vector<BoxT<int>> greedy = {{0, 4, 12, 8}, {4, 0, 8, 12}};
+        PartitionPolygons(greedy, PartitionMode::Greedy);
+        REQUIRE(greedy.size() == 3);
+    }
+
+    SECTION("minimum partition vs brute force") {
+        unsigned seed = 1;
+        auto rnd = [&]() { return (seed = seed * 1103515245 + 12345) >> 16; };
+        for (int iter = 0; iter < 300; ++iter) {
+            int n = 3 + rnd() % 3, m = 3 + rnd() % 3;
+            vector<vector<int>> grid(n, vector<int>(m));
+            vector<BoxT<int>> boxes;
+            for (int i = 0; i < n; ++i)
+                for (int j = 0; j < m; ++j)
+                    if (rnd() % 4 != 0) {
+                        grid[i][j] = 1;
+                        boxes.emplace_back(j, i, j + 1, i + 1);
+                    }
+            auto expectedCells = cellsOf(boxes);
+            int expected = bruteForce(grid, 1000);
+            auto greedy = boxes;
+            PartitionPolygons(boxes);
+            PartitionPolygons(greedy, PartitionMode::Greedy);
+            REQUIRE(cellsOf(boxes) == expectedCells);
+            REQUIRE(cellsOf(greedy) == expectedCells);
+            REQUIRE(boxes.size() == expected);
+            REQUIRE(greedy.size() >= expected);
+        }
+    }
+}
+
+TEST_CASE("GeoFile", "[geofile]") {
+    const string path = "geo_file_test.bin";
+    SECTION("box file round trip") {
+        vector<BoxT<int>> boxes;
+        vector<int> layers;
+        vector<double> weights;
+        for (int i = 0; i < 1000; ++i) {
+            boxes.emplace_back(i, 2 * i, i + 5, 2 * i + 7);
+            layers.push_back(i % 9);
+            weights.push_back(i * 0.5);
+        }
+        REQUIRE(WriteGeoFile(path,
+                             boxes,
+                             {{"layer", sizeof(int), layers.data()}, {"weight", sizeof(double), weights.data()}}));
+        GeoFileView<BoxT<int>> view;
+        REQUIRE(view.Open(path));
+        REQUIRE(view.size() == boxes.size());
+        REQUIRE(vector<BoxT<int>>(view.items().begin(), view.items().end()) == boxes);
+        auto viewLayers = view.payload<int>("layer");
+        auto viewWeights = view.payload<double>("weight");
+        REQUIRE(vector<int>(viewLayers.begin(), viewLayers.end()) == layers);
+        REQUIRE(vector<double>(viewWeights.begin(), viewWeights.end()) == weights);
+        REQUIRE(view.payload<int>("weight").empty());
+        REQUIRE(view.payload<int>("net").empty());
+
+        // wrong geometry/coordinate type
+        GeoFileView<BoxT<double>> doubleView;
+        REQUIRE(!doubleView.Open(path));
+        GeoFileView<PointT<int>> pointView;
+        REQUIRE(!pointView.Open(path));
+    }
+
+    SECTION("point file round trip") {
+        vector<PointT<double>> pts = {{1.5, 2.5}, {-3, 4}};
+        REQUIRE(WriteGeoFile(path, pts));
+        GeoFileView<PointT<double>> view;
+        REQUIRE(view.Open(path));
+        REQUIRE(view.size() == 2);
+        REQUIRE(view[1] == pts[1]);
+        REQUIRE(!GeoFileView<PointT<double>>().Open("no_such_file.bin"));
+    }
+    remove(path.c_str());
+}
+
+TEST_CASE("PackedRTree", "[rtree]") {
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> loc(0, 10000), len(0, 300);
+    vector<BoxT<int>> boxes;
+    for (int i = 0; i < 5000; ++i) {
+        int x = loc(rng), y = loc(rng);
+        boxes.emplace_back(x, y, x + len(rng), y + len(rng));
+    }
+    boxes.emplace_back();  // invalid, never reported
+    vector<BoxT<int>> windows;
+    for (int i = 0; i < 200; ++i) {
+        int x = loc(rng), y = loc(rng);
+        windows.emplace_back(x, y, x + 3 * len(rng), y + 3 * len(rng));
+    }
+    auto check = [&](const PackedRTreeT<int>& tree) {
+        REQUIRE(tree.size() == boxes.size() - 1);
+        for (const auto& window : windows) {
+            vector<int> expected;
+            for (int i = 0; i < static_cast<int>(boxes.size()); ++i) {
+                if (boxes[i].IsValid() && boxes[i].HasIntersectWith(window)) expected.push_back(i);
+            }
+            auto result = tree.Query(window);
+            sort(result.begin(), result.end());
+            REQUIRE(result == expected);
+        }
+    };
+
+    PackedRTreeT<int> tree(boxes, 8);
+    check(tree);
+    const string path = "packed_rtree_test.bin";
+    REQUIRE(tree.Write(path));
+    PackedRTreeT<int> mapped;
+    REQUIRE(mapped.Open(path));
+    REQUIRE(mapped.IsMapped());
+    REQUIRE(mapped.bound() == tree.bound());
+    check(mapped);
+    REQUIRE(!PackedRTreeT<double>().Open(path));
+
+    // moves leave the source empty, also for mapped trees
+    PackedRTreeT<int> moved(std::move(tree));
+    REQUIRE(tree.empty());
+    REQUIRE(tree.Query(BoxT<int>(0, 0, 10000, 10000)).empty());
+    check(moved);
+    {
+        PackedRTreeT<int> movedMapped;
+        movedMapped = std::move(mapped);
+        REQUIRE(!mapped.IsMapped());
+        REQUIRE(mapped.Query(BoxT<int>(0, 0, 10000, 10000)).empty());
+        check(movedMapped);
+    }
+    REQUIRE(mapped.Query(BoxT<int>(0, 0, 10000, 10000)).empty());
+
+    // corrupted files are rejected by Open()
+    std::ostringstream oss;
+    REQUIRE(moved.Write(oss));
+    const string bytes = oss.str();
+    PackedRTreeHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    auto openCorrupted = [&](const std::function<void(string&)>& corrupt) {
+        string corrupted = bytes;
+        corrupt(corrupted);
+        mapped = PackedRTreeT<int>();  // unmap before rewriting the file
+        std::ofstream(path, std::ios::binary).write(corrupted.data(), corrupted.size());
+        return mapped.Open(path);
+    };
+    auto setIdx = [&](string& data, uint64_t node, int32_t idx) {
+        std::memcpy(&data[header.idxsOffset + sizeof(int32_t) * node], &idx, sizeof(idx));
+    };
+    auto setLevelEnd = [&](string& data, uint32_t level, uint64_t end) {
+        std::memcpy(&data[sizeof(header) + sizeof(uint64_t) * level], &end, sizeof(end));
+    };
+    REQUIRE(openCorrupted([](string&) {}));
+    REQUIRE(!openCorrupted([&](string& data) { data.resize(header.idxsOffset + 4); }));
+    REQUIRE(!openCorrupted([&](string& data) { setIdx(data, 3, static_cast<int32_t>(boxes.size())); }));
+    REQUIRE(!openCorrupted([&](string& data) { setIdx(data, 3, -1); }));
+    REQUIRE(!openCorrupted([&](string& data) { setIdx(data, header.numNodes - 1, 0); }));  // root into the leaves
+    REQUIRE(!openCorrupted([&](string& data) { setIdx(data, header.numItems, header.numItems); }));
+    REQUIRE(!openCorrupted([&](string& data) { setLevelEnd(data, 1, header.numItems); }));
+    REQUIRE(!openCorrupted([&](string& data) { setLevelEnd(data, 1, header.numNodes + 1); }));
+    REQUIRE(!mapped.IsMapped());
+
+    PackedRTreeT<int> single(vector<BoxT<int>>{{0, 0, 5, 5}});
+    REQUIRE(single.Query(BoxT<int>(6, 6, 10, 10)).empty());
+    REQUIRE(single.Query(BoxT<int>(5, 5, 10, 10)) == vector<int>{0});
+    PackedRTreeT<int> empty(vector<BoxT<int>>{});
+    REQUIRE(empty.Write(path));
+    REQUIRE(mapped.Open(path));
+    REQUIRE(mapped.empty());
+    REQUIRE(mapped.Query(BoxT<int>(0, 0, 10, 10)).empty());
+    remove(path.c_str());
+}
+
+TEST_CASE("GeoParser", "[parser]") {
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<int> loc(-100000, 100000);
+    vector<BoxT<int>> boxes;
+    vector<PointT<double>> pts;
+    std::ostringstream boxText, ptText;
+    ptText.precision(17);
+    for (int i = 0; i < 2000; ++i) {
+        boxes.emplace_back(loc(rng), loc(rng), loc(rng), loc(rng));
+        pts.emplace_back(loc(rng) * 0.25, loc(rng) * 0.5);
+        boxText << boxes.back() << (i % 3 == 0 ? " " : "\n");
+        ptText << pts.back() << "\r\n";
+    }
+    const string boxStr = boxText.str(), ptStr = ptText.str();
+
+    SECTION("text (serial and chunked in parallel)") {
+        for (size_t chunkSize : {size_t(1) << 20, size_t(100), size_t(7)}) {
+            vector<BoxT<int>> parsedBoxes;
+            vector<PointT<double>> parsedPts;
+            REQUIRE(ParseGeoText(boxStr.data(), boxStr.data() + boxStr.size(), parsedBoxes, 4, chunkSize));
+            REQUIRE(ParseGeoText(ptStr.data(), ptStr.data() + ptStr.size(), parsedPts, 4, chunkSize));
+            REQUIRE(parsedBoxes == boxes);
+            REQUIRE(parsedPts == pts);
+        }
+    }
+
+    SECTION("stream with line-boundary carry") {
+        for (size_t chunkSize : {size_t(1) << 20, size_t(50), size_t(3)}) {
+            std::istringstream iss(boxStr);
+            vector<BoxT<int>> parsedBoxes;
+            REQUIRE(ParseGeoStream(iss, parsedBoxes, 2, chunkSize));
+            REQUIRE(parsedBoxes == boxes);
+        }
+    }
+
+    SECTION("file") {
+        const string path = "geo_parser_test.txt";
+        std::ofstream(path) << ptStr;
+        vector<PointT<double>> parsedPts;
+        REQUIRE(ParseGeoFile(path, parsedPts));
+        REQUIRE(parsedPts == pts);
+        std::ofstream(path).close();
+        parsedPts.clear();
+        REQUIRE(ParseGeoFile(path, parsedPts));  // empty file
+        REQUIRE(parsedPts.empty());
+        remove(path.c_str());
+        REQUIRE(!ParseGeoFile("no_such_file.txt", parsedPts));
+    }
+
+    SECTION("printed vectors and malformed text") {
+        vector<IntervalT<int>> intvls;
+        string text = "[(1, 2), (-3, 4)]\n(+5,6)";
+        REQUIRE(ParseGeoText(text.data(), text.data() + text.size(), intvls));
+        REQUIRE(intvls == vector<IntervalT<int>>{{1, 2}, {-3, 4}, {5, 6}});
+        vector<BoxT<double>> parsedBoxes;
+        text = "[[x: (0, 1), y: (2, 3.5)], [x: (inf, -inf), y: (1e3, 2e3)]]";
+        REQUIRE(ParseGeoText(text.data(), text.data() + text.size(), parsedBoxes));
+        REQUIRE(parsedBoxes.size() == 2);
+        REQUIRE(parsedBoxes[0] == BoxT<double>(0, 2, 1, 3.5));
+        REQUIRE(!parsedBoxes[1].IsValid());
+        for (string bad : {"(1, 2", "(1; 2)", "(1, 2) x (3, 4)", "(a, 2)"}) {
+            vector<PointT<int>> badPts;
+            REQUIRE(!ParseGeoText(bad.data(), bad.data() + bad.size(), badPts));
+        }
+    }
+}
+
+TEST_CASE("RectPolygon", "[polygon]") {
+    SECTION("polygon with a hole") {
+        // L shape with a square hole, given clockwise
+        vector<PointT<int>> outer = {{0, 0}, {0, 10}, {4, 10}, {4, 4}, {10, 4}, {10, 0}};
+        vector<PointT<int>> hole = {{1, 1}, {3, 1}, {3, 3}, {1, 3}};
+        RectilinearPolygonT<int> polygon(outer, {hole});
+        REQUIRE(polygon.area() == 40 + 24 - 4);
+        REQUIRE(polygon.perimeter() == 40 + 8);
+        REQUIRE(polygon.bound() == BoxT<int>(0, 0, 10, 10));
+        REQUIRE(polygon.Contains({0, 0}));
+        REQUIRE(polygon.Contains({4, 10}));
+        REQUIRE(polygon.Contains({2, 1}));
+        REQUIRE(polygon.Contains({10, 2}));
+        REQUIRE(!polygon.Contains({2, 2}));
+        REQUIRE(!polygon.Contains({5, 5}));
+        REQUIRE(!polygon.Contains({11, 2}));
+        REQUIRE(!polygon.Contains({-1, 2}));
+        auto boxes = polygon.ToBoxes();
+        REQUIRE(UnionArea(boxes) == polygon.area());
+        long long sumArea = 0;
+        for (const auto& box : boxes) sumArea += box.area();
+        REQUIRE(sumArea == polygon.area());  // disjoint
+        auto polygons = RectilinearPolygonT<int>::FromBoxes(boxes);
+        REQUIRE(polygons.size() == 1);
+        REQUIRE(polygons[0].holes().size() == 1);
+        REQUIRE(polygons[0].outer().size() == 6);
+        REQUIRE(polygons[0].area() == polygon.area());
+    }
+
+    SECTION("from random boxes") {
+        std::mt19937 rng(11);
+        std::uniform_int_distribution<int> loc(0, 15), len(1, 5);
+        for (int iter = 0; iter < 30; ++iter) {
+            vector<BoxT<int>> boxes;
+            for (int i = 0; i < 25; ++i) {
+                int x = loc(rng), y = loc(rng);
+                boxes.emplace_back(2 * x, 2 * y, 2 * (x + len(rng)), 2 * (y + len(rng)));
+            }
+            auto polygons = RectilinearPolygonT<int>::FromBoxes(boxes);
+            long long sumArea = 0;
+            for (const auto& polygon : polygons) {
+                sumArea += polygon.area();
+                REQUIRE(polygon.outer().size() % 2 == 0);
+                REQUIRE(UnionArea(polygon.ToBoxes()) == polygon.area());
+            }
+            REQUIRE(sumArea == UnionArea(boxes));
+            vector<PointT<int>> pts;
+            for (int x = -1; x <= 42; ++x) {
+                for (int y = -1; y <= 42; ++y) pts.emplace_back(x, y);
+            }
+            vector<char> isInPolygon(pts.size(), false);
+            for (const auto& polygon : polygons) {
+                auto flags = polygon.BatchContains(pts, 3);
+                for (size_t i = 0; i < pts.size(); ++i) {
+                    if (flags[i] != polygon.Contains(pts[i])) FAIL("batch and single queries differ");
+                    isInPolygon[i] |= flags[i];
+                }
+            }
+            vector<char> isInBox(pts.size(), false);
+            for (size_t i = 0; i < pts.size(); ++i) {
+                for (const auto& box : boxes) isInBox[i] |= box.x.Contain(pts[i].x) && box.y.Contain(pts[i].y);
+            }
+            REQUIRE(isInPolygon == isInBox);
+        }
+    }
+}
+
+TEST_CASE("ConvexHull", "[hull]") {
+    SECTION("small hull") {
+        vector<PointT<int>> pts = {{0, 0}, {2, 0}, {4, 0}, {4, 3}, {2, 1}, {0, 3}, {0, 0}, {1, 3}};
+        auto hull = ConvexHull(pts);
+        REQUIRE(hull == vector<PointT<int>>{{0, 0}, {4, 0}, {4, 3}, {0, 3}});
+        REQUIRE(HullDiameter(hull) == std::make_pair(0, 2));
+        REQUIRE(HullWidth(hull) == 3);
+        auto rect = MinAreaRect(hull);
+        REQUIRE(rect.area() == Approx(12));
+        REQUIRE(ConvexHull(vector<PointT<int>>{{1, 1}, {1, 1}}).size() == 1);
+        REQUIRE(ConvexHull(vector<PointT<int>>{{0, 0}, {1, 1}, {2, 2}}) == vector<PointT<int>>{{0, 0}, {2, 2}});
+        REQUIRE(MinAreaRect(vector<PointT<int>>{{0, 0}, {3, 4}}).width == Approx(5));
+        // rotated square in double
+        auto square = ConvexHull(vector<PointT<double>>{{0, 1}, {1, 0}, {2, 1}, {1, 2}, {1, 1}, {0.5, 0.5}});
+        REQUIRE(square.size() == 4);
+        REQUIRE(MinAreaRect(square).area() == Approx(2));
+        REQUIRE(HullWidth(square) == Approx(sqrt(2)));
+    }
+
+    SECTION("random points vs brute force") {
+        std::mt19937 rng(5);
+        std::normal_distribution<double> normal(0, 1e8);
+        vector<PointT<int>> pts;
+        for (int i = 0; i < 200000; ++i) {
+            pts.emplace_back(static_cast<int>(normal(rng)), static_cast<int>(normal(rng) * 0.3));
+        }
+        auto hull = ConvexHull(pts, 4);
+        REQUIRE(hull == ConvexHull(pts, 1));
+        int n = hull.size();
+        REQUIRE(n >= 3);
+        for (int i = 0; i < n; ++i) {
+            // strictly convex and every point on the left of (or on) every edge
+            REQUIRE(Orientation(hull[i], hull[(i + 1) % n], hull[(i + 2) % n]) == 1);
+        }
+        bool isAllInside = true;
+        for (const auto& pt : pts) {
+            for (int i = 0; i < n; ++i) isAllInside &= Cross(hull[i], hull[(i + 1) % n], pt) >= 0;
+        }
+        REQUIRE(isAllInside);
+
+        long long maxDist = 0;
+        double minWidth = std::numeric_limits<double>::max();
+        for (int i = 0; i < n; ++i) {
+            double maxCross = 0;
+            for (int j = 0; j < n; ++j) {
+                maxDist = max(maxDist, SquaredL2Dist(hull[i], hull[j]));
+                maxCross = max(maxCross, static_cast<double>(Cross(hull[i], hull[(i + 1) % n], hull[j])));
+            }
+            minWidth = min(minWidth, maxCross / L2Dist(hull[i], hull[(i + 1) % n]));
+        }
+        auto diameter = HullDiameter(hull);
+        REQUIRE(SquaredL2Dist(hull[diameter.first], hull[diameter.second]) == maxDist);
+        REQUIRE(HullWidth(hull) == Approx(minWidth));
+
+        // minimum-area rectangle vs trying every edge direction
+        double minArea = std::numeric_limits<double>::max();
+        for (int i = 0; i < n; ++i) {
+            double dx = hull[(i + 1) % n].x - hull[i].x, dy = hull[(i + 1) % n].y - hull[i].y;
+            double len = sqrt(dx * dx + dy * dy);
+            IntervalT<double> along, across;
+            for (const auto& pt : hull) {
+                along.Update((pt.x * dx + pt.y * dy) / len);
+                across.Update((pt.y * dx - pt.x * dy) / len);
+            }
+            minArea = min(minArea, along.range() * across.range());
+        }
+        auto rect = MinAreaRect(hull);
+        REQUIRE(rect.area() == Approx(minArea));
+        for (const auto& pt : hull) {
+            for (int i = 0; i < 4; ++i) {
+                const auto& a = rect.corners[i];
+                const auto& b = rect.corners[(i + 1) % 4];
+                double cross = (b.x - a.x) * (pt.y - a.y) - (b.y - a.y) * (pt.x - a.x);
+                REQUIRE(cross >= -1e-6 * rect.area());
+            }
+        }
+    }
+}
+
+TEST_CASE("GeoHash", "[hash]") {
+    SECTION("std::hash") {
+        std::hash<BoxT<int>> boxHash;
+        REQUIRE(boxHash(BoxT<int>(1, 2, 3, 4)) == boxHash(BoxT<int>(1, 2, 3, 4)));
+        REQUIRE(boxHash(BoxT<int>(1, 2, 3, 4)) != boxHash(BoxT<int>(2, 1, 4, 3)));
+        REQUIRE(boxHash(BoxT<int>(3, 2, 1, 4)) == boxHash(BoxT<int>(5, 2, 0, 4)));  // equal invalid x intervals
+        REQUIRE(std::hash<PointT<double>>()({0.0, 1.0}) == std::hash<PointT<double>>()({-0.0, 1.0}));
+        std::unordered_set<PointT<int>> pts = {{1, 2}, {1, 2}, {2, 1}};
+        REQUIRE(pts.size() == 2);
+    }
+
+    SECTION("map/set vs std containers") {
+        std::mt19937 rng(9);
+        std::uniform_int_distribution<int> loc(0, 300);
+        GeoHashMap<PointT<int>, int> map;
+        std::map<pair<int, int>, int> expected;
+        int numMismatches = 0;
+        for (int i = 0; i < 100000; ++i) {
+            PointT<int> pt(loc(rng), loc(rng));
+            int op = i % 5;
+            if (op < 3) {
+                numMismatches += map.Insert(pt, i) != expected.emplace(make_pair(pt.x, pt.y), i).second;
+            } else if (op == 3) {
+                numMismatches += map.Erase(pt) != (expected.erase(make_pair(pt.x, pt.y)) == 1);
+            } else {
+                map[pt] += 1;
+                expected[make_pair(pt.x, pt.y)] += 1;
+            }
+        }
+        REQUIRE(numMismatches == 0);
+        REQUIRE(map.size() == expected.size());
+        size_t numEntries = 0;
+        map.ForEach([&](const PointT<int>& pt, int value) {
+            ++numEntries;
+            numMismatches += expected.at(make_pair(pt.x, pt.y)) != value;
+        });
+        REQUIRE(numMismatches == 0);
+        REQUIRE(numEntries == expected.size());
+        REQUIRE(map.Find(PointT<int>(-1, -1)) == nullptr);
+        map.Clear();
+        REQUIRE(map.empty());
+        REQUIRE(!map.Contains(PointT<int>(0, 0)));
+
+        vector<BoxT<int>> boxes;
+        for (int i = 0; i < 50000; ++i) boxes.emplace_back(loc(rng) % 20, loc(rng) % 20, 30, loc(rng) % 5 + 30);
+        auto deduped = boxes;
+        RemoveDuplicates(deduped);
+        std::unordered_set<BoxT<int>> boxSet(boxes.begin(), boxes.end());
+        REQUIRE(deduped.size() == boxSet.size());
+        REQUIRE(std::unordered_set<BoxT<int>>(deduped.begin(), deduped.end()) == boxSet);
+        REQUIRE(deduped.front() == boxes.front());
+    }
+}
+
+TEST_CASE("PointLocator", "[locator]") {
+    SECTION("small set") {
+        // overlapping boxes, a segment and a point
+        vector<BoxT<int>> boxes = {{0, 0, 10, 10}, {5, 5, 20, 8}, {30, 0, 30, 10}, {40, 40, 40, 40}, BoxT<int>()};
+        PointLocatorT<int> locator(boxes);
+        REQUIRE(locator.Contains({0, 0}));
+        REQUIRE(locator.Contains({20, 8}));
+        REQUIRE(locator.Contains({15, 6}));
+        REQUIRE_FALSE(locator.Contains({15, 9}));
+        REQUIRE(locator.Contains({30, 5}));
+        REQUIRE_FALSE(locator.Contains({29, 5}));
+        REQUIRE(locator.Contains({40, 40}));
+        REQUIRE_FALSE(locator.Contains({40, 41}));
+        REQUIRE_FALSE(locator.Contains({-1, 0}));
+        // out of the bound in x only
+        REQUIRE_FALSE(locator.Contains({41, 5}));
+        REQUIRE_FALSE(locator.Contains({std::numeric_limits<int>::lowest(), 5}));
+        REQUIRE_FALSE(locator.Contains({std::numeric_limits<int>::max(), 5}));
+        REQUIRE_FALSE(PointLocatorT<int>(vector<BoxT<int>>{}).Contains({0, 0}));
+        REQUIRE(PointLocatorT<int>().BatchContains({{0, 0}}) == vector<char>{false});
+        PointLocatorT<double> dblLocator(vector<BoxT<double>>{{0.5, 0.5, 1.5, 2.5}, {1.5, 0, 3, 0.25}});
+        REQUIRE(dblLocator.BatchContains({{1.5, 0.1}, {1.6, 0.3}, {0.5, 2.5}}) == vector<char>{true, false, true});
+        REQUIRE_FALSE(dblLocator.Contains({std::numeric_limits<double>::quiet_NaN(), 1}));
+        REQUIRE_FALSE(dblLocator.Contains({-1e300, 1}));
+    }
+
+    SECTION("random boxes vs brute force") {
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<int> coord(0, 1000), size(0, 60);
+        vector<BoxT<int>> boxes;
+        for (int i = 0; i < 3000; ++i) {
+            int x = coord(rng), y = coord(rng);
+            boxes.emplace_back(x, y, x + size(rng), y + size(rng));
+        }
+        PointLocatorT<int> locator(boxes);
+        vector<PointT<int>> pts;
+        for (int i = 0; i < 20000; ++i) pts.emplace_back(coord(rng), coord(rng));
+        auto flags = locator.BatchContains(pts, 4);
+        REQUIRE(flags == locator.BatchContains(pts, 1));
+        int numMismatches = 0, numCovered = 0;
+        for (size_t i = 0; i < pts.size(); ++i) {
+            bool isCovered = std::any_of(boxes.begin(), boxes.end(), [&](const BoxT<int>& box) {
+                return box.x.Contain(pts[i].x) && box.y.Contain(pts[i].y);
+            });
+            numMismatches += (flags[i] != isCovered) || (locator.Contains(pts[i]) != isCovered);
+            numCovered += isCovered;
+        }
+        REQUIRE(numMismatches == 0);
+        REQUIRE(numCovered > 0);
+        REQUIRE(numCovered < static_cast<int>(pts.size()));
+    }
+}
+
+TEST_CASE("BoundingBoxTracker", "[bbox]") {
+    BoundingBoxTrackerT<int> tracker;
+    REQUIRE(!tracker.bound().IsValid());
+    REQUIRE(tracker.hp() == 0);
+    tracker.Insert(PointT<int>(0, 0));
+    tracker.Insert(PointT<int>(10, 5));
+    tracker.Insert(BoxT<int>(3, -2, 4, 1));
+    REQUIRE(tracker.bound() == BoxT<int>(0, -2, 10, 5));
+    REQUIRE(tracker.MoveDelta(PointT<int>(10, 5), PointT<int>(2, 2)) == -9);
+    REQUIRE(tracker.Move(PointT<int>(10, 5), PointT<int>(2, 2)));
+    REQUIRE(tracker.bound() == BoxT<int>(0, -2, 4, 2));
+    REQUIRE_FALSE(tracker.Remove(PointT<int>(10, 5)));
+    REQUIRE(tracker.size() == 3);
+
+    SECTION("random moves vs recompute") {
+        std::mt19937 rng(11);
+        std::uniform_int_distribution<int> coord(0, 50);
+        vector<PointT<int>> pts;
+        tracker.Clear();
+        for (int i = 0; i < 20; ++i) {
+            pts.emplace_back(coord(rng), coord(rng));
+            tracker.Insert(pts.back());
+        }
+        int numMismatches = 0;
+        for (int iter = 0; iter < 5000; ++iter) {
+            int i = rng() % pts.size();
+            PointT<int> to(coord(rng), coord(rng));
+            BoxT<int> oldBound, newBound;
+            for (int j = 0; j < static_cast<int>(pts.size()); ++j) {
+                oldBound.Update(pts[j]);
+                newBound.Update(j == i ? to : pts[j]);
+            }
+            numMismatches += tracker.MoveDelta(pts[i], to) != newBound.hp() - oldBound.hp();
+            tracker.Move(pts[i], to);
+            pts[i] = to;
+            numMismatches += tracker.bound() != newBound;
+        }
+        REQUIRE(numMismatches == 0);
+    }
+}
+
+TEST_CASE("Hpwl", "[hpwl]") {
+    std::mt19937 rng(13);
+    std::uniform_int_distribution<int> coord(-1000, 1000);
+    // random netlist with a few large nets, pins are shuffled across nets and some are in no net
+    vector<int> netBegins = {0}, netPins;
+    vector<PointT<int>> pinLocs(20000);
+    for (auto& loc : pinLocs) loc = {coord(rng), coord(rng)};
+    vector<int> pins(pinLocs.size());
+    std::iota(pins.begin(), pins.end(), 0);
+    std::shuffle(pins.begin(), pins.end(), rng);
+    for (size_t i = 0; i + 40 < pins.size();) {
+        int degree = rng() % 10 == 0 ? 1 + rng() % 40 : 2 + rng() % 4;
+        for (int k = 0; k < degree; ++k) netPins.push_back(pins[i++]);
+        netBegins.push_back(netPins.size());
+    }
+    auto bruteForce = [&](const vector<PointT<int>>& locs) {
+        long long total = 0;
+        for (size_t net = 0; net + 1 < netBegins.size(); ++net) {
+            BoxT<int> bound;
+            for (int i = netBegins[net]; i < netBegins[net + 1]; ++i) bound.Update(locs[netPins[i]]);
+            total += bound.hp();
+        }
+        return total;
+    };
+
+    NetlistHpwlT<int> hpwl(netBegins, netPins, pinLocs, 4);
+    REQUIRE(hpwl.total() == bruteForce(pinLocs));
+    REQUIRE(hpwl.Evaluate(1) == hpwl.total());
+    REQUIRE(hpwl.pinLoc(netPins[5]) == pinLocs[netPins[5]]);
+    REQUIRE(hpwl.pinNet(pins.back()) == -1);
+
+    int numMismatches = 0;
+    for (int iter = 0; iter < 200; ++iter) {
+        // a batch of distinct pins, possibly sharing nets
+        vector<int> moved;
+        vector<PointT<int>> locs;
+        for (int k = 0; k < 1 + iter % 20; ++k) moved.push_back(rng() % pinLocs.size());
+        std::sort(moved.begin(), moved.end());
+        moved.erase(std::unique(moved.begin(), moved.end()), moved.end());
+        for (int pin : moved) locs.emplace_back(pinLocs[pin].x + coord(rng) / 10, pinLocs[pin].y + coord(rng) / 10);
+        long long oldTotal = hpwl.total(), delta = hpwl.MoveDelta(moved, locs);
+        numMismatches += hpwl.total() != oldTotal;
+        for (size_t k = 0; k < moved.size(); ++k) pinLocs[moved[k]] = locs[k];
+        numMismatches += delta != bruteForce(pinLocs) - oldTotal;
+        numMismatches += hpwl.MovePins(moved, locs) != delta;
+        numMismatches += hpwl.total() != oldTotal + delta;
+    }
+    REQUIRE(numMismatches == 0);
+    REQUIRE(hpwl.total() == hpwl.Evaluate(2));
+
+    SECTION("concurrent move deltas") {
+        const auto& engine = hpwl;
+        vector<long long> deltas(64), expected(64);
+        auto getMove = [&](int i, vector<int>& moved, vector<PointT<int>>& locs) {
+            moved = {i, i + 64, i + 128};
+            locs.clear();
+            for (int pin : moved) locs.emplace_back(pinLocs[pin].x + i, pinLocs[pin].y - i);
+        };
+        vector<int> moved;
+        vector<PointT<int>> locs;
+        for (int i = 0; i < 64; ++i) {
+            getMove(i, moved, locs);
+            expected[i] = engine.MoveDelta(moved, locs);
+        }
+        vector<NetlistHpwlT<int>::MoveScratch> scratches(4);
+        ParallelForRange(
+            0,
+            64,
+            [&](int threadIdx, size_t lo, size_t hi) {
+                vector<int> threadMoved;
+                vector<PointT<int>> threadLocs;
+                for (size_t i = lo; i < hi; ++i) {
+                    getMove(i, threadMoved, threadLocs);
+                    deltas[i] = engine.MoveDelta(threadMoved, threadLocs, scratches[threadIdx]);
+                }
+            },
+            4);
+        REQUIRE(deltas == expected);
+    }
+
+    SECTION("double bounds") {
+        vector<PointT<double>> pts = {{0.5, 2}, {-1, 3}, {4, -2.5}};
+        REQUIRE(PointsBound(pts.data(), pts.size()) == BoxT<double>(-1, -2.5, 4, 3));
+        vector<PointT<int>> intPts = {{3, 4}, {-1, 9}, {7, 0}, {2, 2}, {5, -6}};
+        REQUIRE(PointsBound(intPts.data(), intPts.size()) == BoxT<int>(-1, -6, 7, 9));
+        REQUIRE(!PointsBound(intPts.data(), 0).IsValid());
+    }
+}
+
+TEST_CASE("Connectivity", "[connectivity]") {
+    SECTION("small set") {
+        // a chain touching at edges/corners, an isolated box and an invalid box
+        vector<BoxT<int>> boxes = {{0, 0, 2, 2}, {2, 2, 4, 3}, {10, 0, 11, 1}, {3, 3, 3, 8}, BoxT<int>()};
+        REQUIRE(ConnectedComponents(boxes) == vector<int>{0, 0, 1, 0, 2});
+        // two wires on layer 1 and 3 joined by a via stack through layer 2
+        vector<BoxT<int>> wires = {{0, 0, 10, 1}, {9, 0, 10, 10}, {20, 0, 30, 1}, {9, 0, 10, 6}};
+        vector<int> layers = {1, 3, 1, 2};
+        vector<BoxT<int>> vias = {{9, 0, 10, 1}, {9, 5, 10, 6}, {25, 0, 26, 1}};
+        vector<int> viaLayers = {1, 2, 2};  // the last via is above the third wire, but lands on nothing
+        REQUIRE(ConnectedComponents(wires, layers, vias, viaLayers) == vector<int>{0, 0, 1, 0, 0, 0, 2});
+        // stacked vias of cuts 1 and 2 only connect through a landing pad on layer 2
+        vector<BoxT<int>> metals = {{0, 0, 5, 1}, {0, 0, 5, 1}};
+        vector<int> metalLayers = {1, 3};
+        vector<BoxT<int>> stacked = {{0, 0, 1, 1}, {0, 0, 1, 1}};
+        vector<int> stackedLayers = {1, 2};
+        REQUIRE(ConnectedComponents(metals, metalLayers, stacked, stackedLayers) == vector<int>{0, 1, 0, 1});
+        metals.emplace_back(0, 0, 1, 1);
+        metalLayers.push_back(2);
+        REQUIRE(ConnectedComponents(metals, metalLayers, stacked, stackedLayers) == vector<int>{0, 0, 0, 0, 0});
+    }
+
+    SECTION("random boxes vs brute force") {
+        std::mt19937 rng(17);
+        std::uniform_int_distribution<int> coord(0, 2000), size(0, 30);
+        vector<BoxT<int>> boxes;
+        for (int i = 0; i < 4000; ++i) {
+            int x = coord(rng), y = coord(rng);
+            boxes.emplace_back(x, y, x + size(rng), y + size(rng));
+        }
+        boxes.emplace_back(500, 0, 502, 2000);  // tall boxes (e.g., power stripes)
+        boxes.emplace_back(1500, 300, 1501, 1800);
+        UnionFind uf(boxes.size());
+        for (int i = 0; i < static_cast<int>(boxes.size()); ++i) {
+            for (int j = 0; j < i; ++j) {
+                if (boxes[i].HasIntersectWith(boxes[j])) uf.Union(i, j);
+            }
+        }
+        auto ids = ConnectedComponents(boxes, 4);
+        REQUIRE(ids == GetComponentIds(uf));
+        REQUIRE(ids == ConnectedComponents(boxes, 1));
+        REQUIRE(*std::max_element(ids.begin(), ids.end()) > 100);
+    }
+}
+
+TEST_CASE("Quadtree", "[quadtree]") {
+    // clusters of small boxes plus a few long ones spanning split lines
+    std::mt19937 rng(19);
+    std::normal_distribution<double> normal(0, 200);
+    std::uniform_int_distribution<int> coord(0, 100000), size(0, 50);
+    vector<BoxT<int>> boxes;
+    for (int c = 0; c < 10; ++c) {
+        int cx = coord(rng), cy = coord(rng);
+        for (int i = 0; i < 1000; ++i) {
+            int x = cx + static_cast<int>(normal(rng)), y = cy + static_cast<int>(normal(rng));
+            boxes.emplace_back(x, y, x + size(rng), y + size(rng));
+        }
+    }
+    for (int i = 0; i < 20; ++i) boxes.emplace_back(coord(rng), i * 5000, coord(rng) + 100000, i * 5000 + 10);
+    boxes.emplace_back();
+
+    for (bool isLoose : {false, true}) {
+        QuadtreeT<int> tree(boxes, 8, isLoose);
+        REQUIRE(tree.size() == boxes.size() - 1);
+        REQUIRE(tree.numNodes() > 100);
+        int numMismatches = 0;
+        for (int iter = 0; iter < 300; ++iter) {
+            // windows and points around random boxes
+            const auto& box = boxes[rng() % (boxes.size() - 1)];
+            BoxT<int> window(box.lx() - 100, box.ly() - 100, box.lx() + coord(rng) / 100, box.ly() + coord(rng) / 100);
+            auto idxs = tree.Query(window);
+            std::sort(idxs.begin(), idxs.end());
+            vector<int> expected;
+            for (int i = 0; i < static_cast<int>(boxes.size()); ++i) {
+                if (boxes[i].HasIntersectWith(window)) expected.push_back(i);
+            }
+            numMismatches += idxs != expected;
+
+            PointT<int> pt(box.lx() - 300 + coord(rng) / 150, box.ly() - 300 + coord(rng) / 150);
+            auto nearest = tree.Nearest(pt, 5);
+            vector<int> dists;
+            for (int i = 0; i < static_cast<int>(boxes.size()) - 1; ++i) dists.push_back(Dist(boxes[i], pt));
+            std::sort(dists.begin(), dists.end());
+            for (int k = 0; k < 5; ++k) numMismatches += Dist(boxes[nearest[k]], pt) != dists[k];
+        }
+        REQUIRE(numMismatches == 0);
+    }
+    REQUIRE(QuadtreeT<int>(vector<BoxT<int>>{}).Nearest({0, 0}) == -1);
+    REQUIRE(QuadtreeT<int>(vector<BoxT<int>>{{0, 0, 1, 1}, {5, 5, 6, 6}}).Nearest({4, 4}) == 1);
+}
+
+TEST_CASE("Tiling", "[tiling]") {
+    std::mt19937 rng(23);
+    std::uniform_int_distribution<int> coord(0, 1000), size(1, 80);
+    vector<BoxT<int>> boxes;
+    for (int i = 0; i < 300; ++i) {
+        int x = coord(rng), y = coord(rng);
+        boxes.emplace_back(x, y, x + size(rng), y + size(rng));
+    }
+    BoxT<int> bound;
+    for (const auto& box : boxes) bound = bound.UnionWith(box);
+    auto sortBoxes = [](vector<BoxT<int>> sorted) {
+        std::sort(sorted.begin(), sorted.end(), [](const BoxT<int>& lhs, const BoxT<int>& rhs) {
+            return std::make_tuple(lhs.lx(), lhs.ly(), lhs.hx(), lhs.hy()) <
+                   std::make_tuple(rhs.lx(), rhs.ly(), rhs.hx(), rhs.hy());
+        });
+        return sorted;
+    };
+    auto area = UnionArea(boxes);
+
+    SECTION("union area and slicing") {
+        REQUIRE(TiledUnionArea(boxes, TilingT<int>(bound, 5, 3), 4) == area);
+        // strips spanning the slice direction give the same slicing
+        vector<BoxT<int>> sliced = boxes, tiledSliced = boxes;
+        SlicePolygons(sliced, 1);
+        TiledSlicePolygons(tiledSliced, 1, TilingT<int>(bound, 6, 1), 4);
+        REQUIRE(sortBoxes(tiledSliced) == sortBoxes(sliced));
+        // 2D tiles give disjoint boxes of the same union
+        TilingT<int> tiling(bound, 4, 4);
+        REQUIRE(tiling.numTiles() == 16);
+        REQUIRE(tiling.core(15).hx() == bound.hx());
+        tiledSliced = boxes;
+        TiledSlicePolygons(tiledSliced, 1, tiling, 4);
+        WideT<int> sum = 0;
+        for (const auto& box : tiledSliced) sum += box.area();
+        REQUIRE(sum == area);
+        REQUIRE(UnionArea(tiledSliced) == area);
+    }
+
+    SECTION("spacing check with halo") {
+        // a close pair is seen by the tile whose core holds the closest point of one of the boxes, thanks to the halo
+        // (boxes clipped to a tile may no longer overlap, so the original boxes are checked for that)
+        const int spacing = 10;
+        TilingT<int> tiling(bound, 3, 3, spacing);
+        auto tilePairs = RunTiles(
+            boxes,
+            tiling,
+            [&](int, const vector<BoxT<int>>& tileBoxes, const vector<int>& boxIdxs) {
+                vector<std::pair<int, int>> pairs;
+                for (const auto& pair : FindSpacingViolations(tileBoxes, spacing)) {
+                    int i = boxIdxs[pair.first], j = boxIdxs[pair.second];
+                    if (!boxes[i].HasIntersectWith(boxes[j])) pairs.emplace_back(std::min(i, j), std::max(i, j));
+                }
+                return pairs;
+            },
+            4);
+        std::set<std::pair<int, int>> found;
+        for (const auto& pairs : tilePairs) found.insert(pairs.begin(), pairs.end());
+        auto expected = FindSpacingViolations(boxes, spacing);
+        REQUIRE(found == std::set<std::pair<int, int>>(expected.begin(), expected.end()));
+    }
+}
+
+TEST_CASE("BoxExpr", "[boxexpr]") {
+    std::mt19937 rng(29);
+    std::uniform_int_distribution<int> coord(0, 60), size(1, 12);
+    vector<BoxT<int>> sets[4];
+    for (auto& boxes : sets) {
+        for (int i = 0; i < 40; ++i) {
+            int x = coord(rng), y = coord(rng);
+            boxes.emplace_back(x, y, x + size(rng), y + size(rng));
+        }
+    }
+    const auto &a = sets[0], &b = sets[1], &c = sets[2], &d = sets[3];
+    // brute-force coverage of unit cells
+    auto cells = [](const vector<BoxT<int>>& boxes) {
+        set<pair<int, int>> covered;
+        for (const auto& box : boxes)
+            for (int x = box.lx(); x < box.hx(); ++x)
+                for (int y = box.ly(); y < box.hy(); ++y) covered.emplace(x, y);
+        return covered;
+    };
+    auto sortBoxes = [](vector<BoxT<int>> sorted) {
+        std::sort(sorted.begin(), sorted.end(), [](const BoxT<int>& lhs, const BoxT<int>& rhs) {
+            return std::make_tuple(lhs.lx(), lhs.ly(), lhs.hx(), lhs.hy()) <
+                   std::make_tuple(rhs.lx(), rhs.ly(), rhs.hx(), rhs.hy());
+        });
+        return sorted;
+    };
+
+    SECTION("single operations") {
+        vector<BoxT<int>> ab = a;
+        ab.insert(ab.end(), b.begin(), b.end());
+        REQUIRE(sortBoxes(EvaluateBoxSet(BoxSet(a) | BoxSet(b))) == sortBoxes(UnionBoxes(ab)));
+        REQUIRE(sortBoxes(EvaluateBoxSet(BoxSet(a))) == sortBoxes(UnionBoxes(a)));
+        auto cellsA = cells(a), cellsB = cells(b);
+        set<pair<int, int>> expected[3];  // intersection, difference and symmetric difference
+        for (const auto& cell : cellsA) (cellsB.count(cell) ? expected[0] : expected[1]).insert(cell);
+        std::set_symmetric_difference(cellsA.begin(),
+                                      cellsA.end(),
+                                      cellsB.begin(),
+                                      cellsB.end(),
+                                      std::inserter(expected[2], expected[2].end()));
+        REQUIRE(cells(EvaluateBoxSet(BoxSet(a) & BoxSet(b))) == expected[0]);
+        REQUIRE(cells(EvaluateBoxSet(BoxSet(a) - BoxSet(b))) == expected[1]);
+        REQUIRE(cells(EvaluateBoxSet(BoxSet(a) ^ BoxSet(b))) == expected[2]);
+        REQUIRE(EvaluateBoxSet(BoxSet(a) - BoxSet(a)).empty());
+    }
+
+    SECTION("fused equals step by step") {
+        auto fused = EvaluateBoxSet(((BoxSet(a) | BoxSet(b)) & BoxSet(c)) - BoxSet(d));
+        auto ab = EvaluateBoxSet(BoxSet(a) | BoxSet(b));
+        auto abc = EvaluateBoxSet(BoxSet(ab) & BoxSet(c));
+        auto stepwise = EvaluateBoxSet(BoxSet(abc) - BoxSet(d));
+        REQUIRE(!fused.empty());
+        REQUIRE(sortBoxes(fused) == sortBoxes(stepwise));
+        for (size_t i = 0; i < fused.size(); ++i) {
+            for (size_t j = 0; j < i; ++j) REQUIRE(!fused[i].HasStrictIntersectWith(fused[j]));
+        }
+        // the same operand in several leaves
+        REQUIRE(sortBoxes(EvaluateBoxSet((BoxSet(a) ^ BoxSet(b)) | (BoxSet(a) & BoxSet(b)))) ==
+                sortBoxes(EvaluateBoxSet(BoxSet(a) | BoxSet(b))));
+    }
+
+    SECTION("large boxes and many operands") {
+        vector<BoxT<int>> all = {{-5, -5, 80, 80}}, ab = a;
+        ab.insert(ab.end(), b.begin(), b.end());
+        REQUIRE(EvaluateBoxSet(BoxSet(a) | BoxSet(all)) == all);
+        REQUIRE(EvaluateBoxSet(BoxSet(a) - BoxSet(all)).empty());
+        REQUIRE(cells(EvaluateBoxSet(BoxSet(all) - BoxSet(a) - BoxSet(b))).size() == 85 * 85 - cells(ab).size());
+        // 8 operands (wider mask tables)
+        auto expr =
+            ((BoxSet(a) | BoxSet(b)) & (BoxSet(c) | BoxSet(d))) ^ ((BoxSet(a) & BoxSet(c)) | (BoxSet(b) & BoxSet(d)));
+        auto lhs = EvaluateBoxSet((BoxSet(a) | BoxSet(b)) & (BoxSet(c) | BoxSet(d)));
+        auto rhs = EvaluateBoxSet((BoxSet(a) & BoxSet(c)) | (BoxSet(b) & BoxSet(d)));
+        REQUIRE(sortBoxes(EvaluateBoxSet(expr)) == sortBoxes(EvaluateBoxSet(BoxSet(lhs) ^ BoxSet(rhs))));
+    }
+}
+
+TEST_CASE("IntervalGraph", "[intervalgraph]") {
+    std::mt19937 rng(31);
+    std::uniform_int_distribution<int> coord(0, 100), length(0, 15), weight(1, 20);
+
+    SECTION("track assignment") {
+        vector<IntervalT<int>> intvls = {{0, 5}, {5, 8}, {6, 9}, {10, 12}, {3, 2}};
+        vector<int> tracks;
+        REQUIRE(AssignTracks(intvls, tracks) == 2);
+        REQUIRE(tracks[0] != tracks[1]);  // touching ones conflict
+        REQUIRE(tracks[4] == -1);
+        for (int iter = 0; iter < 20; ++iter) {
+            intvls.clear();
+            for (int i = 0; i < 200; ++i) {
+                int lo = coord(rng);
+                intvls.emplace_back(lo, lo + length(rng));
+            }
+            int numTracks = AssignTracks(intvls, tracks), maxDensity = 0, numMismatches = 0;
+            for (int x = 0; x <= 115; ++x) {
+                int density = 0;
+                for (const auto& intvl : intvls) density += intvl.Contain(x);
+                maxDensity = std::max(maxDensity, density);
+            }
+            for (int i = 0; i < intvls.size(); ++i) {
+                if (tracks[i] < 0 || tracks[i] >= numTracks) ++numMismatches;
+                for (int j = 0; j < i; ++j) {
+                    numMismatches += tracks[i] == tracks[j] && intvls[i].HasIntersectWith(intvls[j]);
+                }
+            }
+            REQUIRE(numMismatches == 0);
+            REQUIRE(numTracks == maxDensity);
+        }
+    }
+
+    SECTION("max weight independent set") {
+        for (int iter = 0; iter < 50; ++iter) {
+            vector<IntervalT<int>> intvls;
+            vector<int> weights;
+            for (int i = 0; i < 12; ++i) {
+                int lo = coord(rng) / 2;
+                intvls.emplace_back(lo, lo + length(rng));
+                weights.push_back(weight(rng));
+            }
+            vector<int> selected;
+            int total = MaxWeightIndependentIntervals(intvls, weights, selected);
+            int sum = 0;
+            for (int k = 0; k < selected.size(); ++k) {
+                sum += weights[selected[k]];
+                for (int l = 0; l < k; ++l) REQUIRE(!intvls[selected[k]].HasIntersectWith(intvls[selected[l]]));
+            }
+            REQUIRE(sum == total);
+            // brute force over subsets
+            int expected = 0;
+            for (int mask = 0; mask < (1 << intvls.size()); ++mask) {
+                int w = 0;
+                bool isIndependent = true;
+                for (int i = 0; i < intvls.size() && isIndependent; ++i) {
+                    if (!(mask >> i & 1)) continue;
+                    w += weights[i];
+                    for (int j = 0; j < i; ++j) {
+                        isIndependent &= !((mask >> j & 1) && intvls[i].HasIntersectWith(intvls[j]));
+                    }
+                }
+                if (isIndependent) expected = std::max(expected, w);
+            }
+            REQUIRE(total == expected);
+        }
+    }
+}
+
+TEST_CASE("Transform", "[transform]") {
+    std::mt19937 rng(37);
+    std::uniform_int_distribution<int> coord(-1000, 1000), size(0, 100), orientDist(0, 7);
+    auto randOrient = [&]() { return static_cast<Orient>(orientDist(rng)); };
+    // definitions: FN = MY, FS = MX, FE = MY90, FW = MX90
+    PointT<int> pt(3, 5);
+    vector<PointT<int>> expected = {{3, 5}, {-5, 3}, {-3, -5}, {5, -3}, {-3, 5}, {-5, -3}, {3, -5}, {5, 3}};
+    for (int o = 0; o < 8; ++o) REQUIRE(TransformT<int>(static_cast<Orient>(o), {0, 0})(pt) == expected[o]);
+
+    SECTION("composition and inverse") {
+        int numMismatches = 0;
+        for (int iter = 0; iter < 1000; ++iter) {
+            TransformT<int> t1(randOrient(), {coord(rng), coord(rng)}), t2(randOrient(), {coord(rng), coord(rng)});
+            PointT<int> p(coord(rng), coord(rng));
+            numMismatches += (t2 * t1)(p) != t2(t1(p));
+            numMismatches += t1.Inverse()(t1(p)) != p;
+            numMismatches += (t1 * t1.Inverse()) != TransformT<int>();
+            // boxes are normalized to the bound of the transformed corners
+            BoxT<int> box(p.x, p.y, p.x + size(rng), p.y + size(rng)), corners;
+            corners.Update(t1(PointT<int>(box.lx(), box.ly())));
+            corners.Update(t1(PointT<int>(box.hx(), box.hy())));
+            numMismatches += t1(box) != corners;
+        }
+        REQUIRE(numMismatches == 0);
+        auto trans = TransformT<int>::Placement(Orient::W, {100, 200}, {0, 0, 10, 20});
+        REQUIRE(trans(BoxT<int>(0, 0, 10, 20)) == BoxT<int>(100, 200, 120, 210));
+    }
+
+    SECTION("batch") {
+        vector<BoxT<int>> boxes;
+        vector<PointT<int>> pts;
+        for (int i = 0; i < 101; ++i) {
+            int x = coord(rng), y = coord(rng);
+            boxes.emplace_back(x, y, x + size(rng), y + size(rng));
+            pts.emplace_back(x, y);
+        }
+        int numMismatches = 0;
+        for (int o = 0; o < 8; ++o) {
+            TransformT<int> trans(static_cast<Orient>(o), {coord(rng), coord(rng)});
+            vector<BoxT<int>> outBoxes(boxes.size()), inPlace = boxes;
+            vector<PointT<int>> outPts(pts.size());
+            trans.Apply(boxes, outBoxes);
+            trans.Apply(pts, outPts);
+            trans.Apply(inPlace);
+            for (int i = 0; i < boxes.size(); ++i) {
+                numMismatches += outBoxes[i] != trans(boxes[i]) || inPlace[i] != outBoxes[i];
+                numMismatches += outPts[i] != trans(pts[i]);
+            }
+            // generic path
+            vector<BoxT<double>> dBoxes = {{-1.5, 2, 3, 4.5}};
+            TransformT<double> dTrans(static_cast<Orient>(o), {1, 2});
+            dTrans.Apply(dBoxes);
+            numMismatches += dBoxes[0] != dTrans(BoxT<double>(-1.5, 2, 3, 4.5));
+        }
+        vector<TransformT<int>> transforms;
+        for (int i = 0; i < 300; ++i) transforms.emplace_back(randOrient(), PointT<int>(coord(rng), coord(rng)));
+        vector<BoxT<int>> placed;
+        PlaceInstances(boxes, transforms, placed, 4);
+        REQUIRE(placed.size() == boxes.size() * transforms.size());
+        for (int i = 0; i < transforms.size(); ++i) {
+            for (int k = 0; k < boxes.size(); ++k) {
+                numMismatches += placed[i * boxes.size() + k] != transforms[i](boxes[k]);
+            }
+        }
+        REQUIRE(numMismatches == 0);
+    }
+}
+
+TEST_CASE("NeighborGraph", "[neighborgraph]") {
+    std::mt19937 rng(41);
+    std::uniform_int_distribution<int> coord(0, 300), clusterCoord(0, 10);
+    vector<PointT<int>> points;
+    for (int i = 0; i < 1500; ++i) points.emplace_back(coord(rng), coord(rng));
+    for (int i = 0; i < 300; ++i) points.emplace_back(100 + clusterCoord(rng), 100 + clusterCoord(rng));  // dense
+    int numPts = points.size();
+    for (auto metric : {DistMetric::L1, DistMetric::L2, DistMetric::LInf}) {
+        vector<int> begins, neighbors, begins1, neighbors1;
+        NeighborGraph(points, 12, metric, begins, neighbors, 4);
+        NeighborGraph(points, 12, metric, begins1, neighbors1, 1);
+        REQUIRE(begins == begins1);
+        REQUIRE(neighbors == neighbors1);
+        REQUIRE(begins.size() == numPts + 1);
+        int numMismatches = 0;
+        for (int i = 0; i < numPts; ++i) {
+            vector<int> expected;
+            for (int j = 0; j < numPts; ++j) {
+                if (j != i && IsWithinDist(points[i], points[j], 12, metric)) expected.push_back(j);
+            }
+            numMismatches += vector<int>(neighbors.begin() + begins[i], neighbors.begin() + begins[i + 1]) != expected;
+        }
+        REQUIRE(numMismatches == 0);
+    }
+    vector<int> begins, neighbors;
+    NeighborGraph(vector<PointT<int>>(), 5, DistMetric::L2, begins, neighbors);
+    REQUIRE(begins == vector<int>{0});
+    REQUIRE(neighbors.empty());
+}
+
+TEST_CASE("Containment", "[containment]") {
+    std::mt19937 rng(43);
+    // hierarchy by random guillotine cuts, children shrunk by 0-2 on each side (so siblings and parents may touch)
+    vector<BoxT<int>> boxes;
+    std::function<void(const BoxT<int>&, int)> generate = [&](const BoxT<int>& box, int depth) {
+        boxes.push_back(box);
+        if (rng() % 8 == 0) boxes.push_back(box);  // duplicate
+        if (depth == 4) return;
+        int dir = rng() % 2, numCuts = 1 + rng() % 3;
+        vector<int> cuts = {box[dir].low, box[dir].high};
+        for (int k = 0; k < numCuts; ++k) cuts.push_back(box[dir].low + rng() % (box[dir].range() + 1));
+        std::sort(cuts.begin(), cuts.end());
+        for (int k = 0; k + 1 < cuts.size(); ++k) {
+            BoxT<int> child = box;
+            child[dir].Set(cuts[k], cuts[k + 1]);
+            child.Set(child.lx() + rng() % 3, child.ly() + rng() % 3, child.hx() - rng() % 3, child.hy() - rng() % 3);
+            if (child.IsStrictValid()) generate(child, depth + 1);
+        }
+    };
+    generate({0, 0, 400, 400}, 0);
+    generate({400, 100, 700, 400}, 0);  // touching the first one
+    boxes.emplace_back(5, 5, 5, 9);     // degenerated
+    std::shuffle(boxes.begin(), boxes.end(), rng);
+
+    // against the definition, by brute force
+    auto check = [&]() {
+        for (bool isStrict : {false, true}) {
+            auto parents = ContainmentForest(boxes, isStrict, 4);
+            REQUIRE(parents == ContainmentForest(boxes, isStrict, 1));
+            int numMismatches = 0;
+            for (int i = 0; i < boxes.size(); ++i) {
+                if (!boxes[i].IsStrictValid()) {
+                    numMismatches += parents[i] != -1;
+                    continue;
+                }
+                int expected = -1;
+                for (int j = 0; j < boxes.size(); ++j) {
+                    if (j == i || !boxes[j].IsStrictValid() || !IsContainedIn(boxes[i], boxes[j], isStrict)) continue;
+                    if (boxes[j] == boxes[i] && j > i) continue;
+                    if (expected < 0 || boxes[j].area() < boxes[expected].area() ||
+                        (boxes[j].area() == boxes[expected].area() && j > expected)) {
+                        expected = j;
+                    }
+                }
+                numMismatches += parents[i] != expected;
+            }
+            REQUIRE(numMismatches == 0);
+        }
+    };
+    check();
+
+    // arbitrary overlaps
+    boxes = {{5, 0, 50, 20}, {10, 10, 100, 100}, {30, 30, 40, 40}};
+    REQUIRE(ContainmentForest(boxes) == vector<int>{-1, -1, 1});
+    check();
+    std::uniform_int_distribution<int> coord(0, 100), size(1, 50);
+    for (int numBoxes : {50, 500, 2000}) {
+        boxes.clear();
+        for (int i = 0; i < numBoxes; ++i) {
+            int x = coord(rng), y = coord(rng);
+            boxes.emplace_back(x, y, x + size(rng), y + size(rng));
+            if (rng() % 8 == 0) boxes.push_back(boxes[rng() % boxes.size()]);  // duplicate
+        }
+        check();
+    }
+}
+
+TEST_CASE("Assignment", "[assignment]") {
+    std::mt19937 rng(47);
+    std::uniform_int_distribution<int> coord(0, 50);
+    auto totalCost = [](const vector<PointT<int>>& points, const vector<PointT<int>>& slots, const vector<int>& idxs) {
+        long long cost = 0;
+        for (int i = 0; i < points.size(); ++i) cost += Dist(points[i], slots[idxs[i]]);
+        return cost;
+    };
+    auto isValid = [](const vector<int>& idxs, int numSlots) {
+        vector<char> isUsed(numSlots, false);
+        for (int idx : idxs) {
+            if (idx < 0 || idx >= numSlots || isUsed[idx]) return false;
+            isUsed[idx] = true;
+        }
+        return true;
+    };
+
+    SECTION("optimality") {
+        for (int iter = 0; iter < 30; ++iter) {
+            vector<PointT<int>> points, slots;
+            for (int i = 0; i < 6; ++i) points.emplace_back(coord(rng), coord(rng));
+            for (int i = 0; i < 6 + iter % 3; ++i) slots.emplace_back(coord(rng), coord(rng));
+            // brute force over injective assignments
+            long long best = std::numeric_limits<long long>::max();
+            vector<int> perm(slots.size());
+            std::iota(perm.begin(), perm.end(), 0);
+            do {
+                best = std::min(best, totalCost(points, slots, perm));
+            } while (std::next_permutation(perm.begin(), perm.end()));
+            auto idxs = AssignToSlots(points, slots, slots.size());
+            REQUIRE(isValid(idxs, slots.size()));
+            REQUIRE(totalCost(points, slots, idxs) == best);
+            // sparse candidates are grown until feasible
+            idxs = AssignToSlots(points, slots, 1);
+            REQUIRE(isValid(idxs, slots.size()));
+            REQUIRE(totalCost(points, slots, idxs) >= best);
+        }
+        REQUIRE(AssignToSlots(vector<PointT<int>>(3), vector<PointT<int>>(2)) == vector<int>(3, -1));
+    }
+
+    SECTION("parallel bidding") {
+        std::uniform_int_distribution<int> wide(0, 1000);
+        vector<PointT<int>> points, slots;
+        for (int i = 0; i < 3000; ++i) points.emplace_back(wide(rng), wide(rng) / 4);  // crowded in y
+        for (int i = 0; i < 3500; ++i) slots.emplace_back(wide(rng), wide(rng));
+        auto idxs = AssignToSlots(points, slots, 8, 4);
+        REQUIRE(isValid(idxs, slots.size()));
+        REQUIRE(idxs == AssignToSlots(points, slots, 8, 1));
+        vector<PointT<double>> dPoints, dSlots;
+        for (const auto& pt : points) dPoints.emplace_back(pt.x + 0.5, pt.y);
+        for (const auto& slot : slots) dSlots.emplace_back(slot.x, slot.y);
+        REQUIRE(isValid(AssignToSlots(dPoints, dSlots, 8, 4), slots.size()));
+    }
+}
@@ -0,0 +1,281 @@
+//
+// Min-cost assignment of points to slots under L-1 distance (e.g., legalization, pin assignment)
+// No cost matrix is built: every point only considers its numCandidates nearest slots (from a QuadtreeT). While the
+// candidate graph has no perfect matching (checked by Hopcroft-Karp), the points of a set with too few candidate slots
+// in total also get their nearest slots out of that neighborhood, so crowded regions reach farther slots.
+// The assignment is then solved by the auction algorithm with epsilon-scaling: unassigned points bid for their best
+// slots in parallel (Jacobi bidding), the highest bid on every slot wins, and slots left over (there may be more
+// slots than points) get their prices lowered by reverse auction iterations, as needed for asymmetric problems.
+// For integer coordinates, the costs are scaled by (#points + 1) and the last epsilon is 1, so the result is optimal
+// over the candidate graph; for floating-point ones it is within #points * 1e-9 * (max cost) of that.
+//
+// Usage:
+//     auto slotIdxs = AssignToSlots(cells, sites);  // cell i goes to sites[slotIdxs[i]]
+//
+
+#pragma once
+
+#include <numeric>
+#include <type_traits>
+
+#include "geo.h"
+#include "parallel.h"
+#include "quadtree.h"
+
+namespace utils {
+
+// Whether the bipartite graph has a matching covering all left vertices (Hopcroft-Karp with iterative searches)
+// adj[begins[u], begins[u + 1]) are the right vertices (in [0, numRight)) adjacent to left vertex u.
+// If not, isDeficient (if given) marks the left vertices reachable from the unmatched ones by alternating paths, whose
+// neighborhood is too small (Hall's condition).
+inline bool HasPerfectMatching(const std::vector<int>& begins,
+                               const std::vector<int>& adj,
+                               int numRight,
+                               std::vector<char>* isDeficient = nullptr) {
+    int numLeft = static_cast<int>(begins.size()) - 1;
+    std::vector<int> matchL(numLeft, -1), matchR(numRight, -1), dist(numLeft), its(numLeft), queue, stack;
+    int numMatched = 0;
+    for (int u = 0; u < numLeft; ++u) {  // greedy start
+        for (int k = begins[u]; k < begins[u + 1] && matchL[u] < 0; ++k) {
+            if (matchR[adj[k]] < 0) {
+                matchL[u] = adj[k];
+                matchR[adj[k]] = u;
+                ++numMatched;
+            }
+        }
+    }
+    while (numMatched < numLeft) {
+        // layers by BFS from the free left vertices
+        queue.clear();
+        for (int u = 0; u < numLeft; ++u) {
+            dist[u] = matchL[u] < 0 ? 0 : -1;
+            if (matchL[u] < 0) queue.push_back(u);
+        }
+        bool hasPath = false;
+        for (size_t h = 0; h < queue.size(); ++h) {
+            int u = queue[h];
+            for (int k = begins[u]; k < begins[u + 1]; ++k) {
+                int w = matchR[adj[k]];
+                if (w < 0) {
+                    hasPath = true;
+                } else if (dist[w] < 0) {
+                    dist[w] = dist[u] + 1;
+                    queue.push_back(w);
+                }
+            }
+        }
+        if (!hasPath) {
+            if (isDeficient) {
+                isDeficient->assign(numLeft, false);
+                for (int u : queue) (*isDeficient)[u] = true;
+            }
+            break;
+        }
+        // vertex-disjoint augmenting paths along the layers
+        for (int u = 0; u < numLeft; ++u) its[u] = begins[u];
+        for (int root = 0; root < numLeft; ++root) {
+            if (matchL[root] >= 0) continue;
+            stack.assign(1, root);
+            while (!stack.empty()) {
+                int x = stack.back();
+                if (its[x] == begins[x + 1]) {
+                    dist[x] = -1;  // dead end
+                    stack.pop_back();
+                    continue;
+                }
+                int v = adj[its[x]++], w = matchR[v];
+                if (w < 0) {
+                    // the last tried edge of every vertex on the stack leads to the next one
+                    for (int s : stack) {
+                        matchL[s] = adj[its[s] - 1];
+                        matchR[matchL[s]] = s;
+                    }
+                    ++numMatched;
+                    break;
+                }
+                if (dist[w] == dist[x] + 1) stack.push_back(w);
+            }
+        }
+    }
+    return numMatched == numLeft;
+}
+
+// slotIdxs[i]: slot of points[i] (all distinct), minimizing the total L-1 distance over the candidate graph
+// All -1 if there are fewer slots than points.
+template <typename T>
+std::vector<int> AssignToSlots(const std::vector<PointT<T>>& points,
+                               const std::vector<PointT<T>>& slots,
+                               int numCandidates = 16,
+                               int numThreads = 0) {
+    using Cost = std::conditional_t<std::is_floating_point<T>::value, double, long long>;
+    int numPts = points.size(), numSlots = slots.size();
+    std::vector<int> slotIdxs(numPts, -1);
+    if (numPts == 0 || numPts > numSlots) return slotIdxs;
+
+    // 1. candidates: the numCandidates nearest slots of each point; while some set S of points has too few slots N(S)
+    // among its candidates, each point of S also gets its numCandidates nearest slots out of N(S)
+    // (arcs of point i: [begins[i], begins[i + 1]))
+    int numNearest = std::min(std::max(numCandidates, 1), numSlots);
+    std::vector<std::vector<int>> candidates(numPts);
+    std::vector<int> begins(numPts + 1), arcSlots, others(numSlots);
+    std::iota(others.begin(), others.end(), 0);
+    std::vector<char> isDeficient(numPts, true), isReached(numSlots);
+    while (true) {
+        std::vector<BoxT<T>> otherBoxes;
+        otherBoxes.reserve(others.size());
+        for (int j : others) otherBoxes.emplace_back(slots[j]);
+        QuadtreeT<T> tree(otherBoxes);
+        int num = std::min<int>(numNearest, others.size());
+        ParallelFor(
+            0,
+            numPts,
+            [&](size_t i) {
+                if (!isDeficient[i]) return;
+                for (int idx : tree.Nearest(points[i], num)) candidates[i].push_back(others[idx]);
+            },
+            numThreads,
+            256);
+        for (int i = 0; i < numPts; ++i) begins[i + 1] = begins[i] + candidates[i].size();
+        arcSlots.resize(begins[numPts]);
+        for (int i = 0; i < numPts; ++i) {
+            std::copy(candidates[i].begin(), candidates[i].end(), arcSlots.begin() + begins[i]);
+        }
+        if (HasPerfectMatching(begins, arcSlots, numSlots, &isDeficient)) break;
+        std::fill(isReached.begin(), isReached.end(), false);
+        for (int i = 0; i < numPts; ++i) {
+            if (!isDeficient[i]) continue;
+            for (int a = begins[i]; a < begins[i + 1]; ++a) isReached[arcSlots[a]] = true;
+        }
+        others.clear();
+        for (int j = 0; j < numSlots; ++j) {
+            if (!isReached[j]) others.push_back(j);
+        }
+    }
+    std::vector<std::vector<int>>().swap(candidates);
+    size_t numArcs = arcSlots.size();
+    std::vector<int> arcPoints(numArcs);
+    for (int i = 0; i < numPts; ++i) std::fill(arcPoints.begin() + begins[i], arcPoints.begin() + begins[i + 1], i);
+    Cost scale = std::is_floating_point<T>::value ? 1 : numPts + 1, maxCost = 0;
+    std::vector<Cost> costs(numArcs);
+    for (size_t a = 0; a < numArcs; ++a) {
+        costs[a] = static_cast<Cost>(Dist(points[arcPoints[a]], slots[arcSlots[a]])) * scale;
+        maxCost = std::max(maxCost, costs[a]);
+    }
+    // arcs by slot, for reverse iterations
+    std::vector<int> slotBegins(numSlots + 1, 0), slotArcs(numArcs);
+    for (int slot : arcSlots) ++slotBegins[slot + 1];
+    for (int j = 0; j < numSlots; ++j) slotBegins[j + 1] += slotBegins[j];
+    std::vector<int> fill(slotBegins.begin(), slotBegins.end() - 1);
+    for (size_t a = 0; a < numArcs; ++a) slotArcs[fill[arcSlots[a]]++] = a;
+
+    // 2. auction, maximizing the benefit -cost
+    Cost minEps = std::is_floating_point<T>::value ? std::max<Cost>(maxCost * 1e-9, 1e-12) : 1;
+    Cost eps = std::max(maxCost / 4, minEps);
+    const Cost infBenefit = std::numeric_limits<Cost>::lowest() / 4;
+    std::vector<Cost> prices(numSlots, 0), profits(numPts, 0), bidPrices(numPts);
+    std::vector<int> owners(numSlots), pointArcs(numPts), unassigned(numPts), next, bidArcs(numPts),
+        bestBids(numSlots, -1), touched, queue;
+    while (true) {
+        // forward: Jacobi bidding of all unassigned points until every point is assigned
+        std::fill(owners.begin(), owners.end(), -1);
+        std::fill(pointArcs.begin(), pointArcs.end(), -1);
+        unassigned.resize(numPts);
+        std::iota(unassigned.begin(), unassigned.end(), 0);
+        while (!unassigned.empty()) {
+            ParallelFor(
+                0,
+                unassigned.size(),
+                [&](size_t u) {
+                    int i = unassigned[u], bestArc = -1;
+                    Cost best = infBenefit, second = infBenefit;
+                    for (int a = begins[i]; a < begins[i + 1]; ++a) {
+                        Cost val = -costs[a] - prices[arcSlots[a]];
+                        if (val > best) {
+                            second = best;
+                            best = val;
+                            bestArc = a;
+                        } else if (val > second) {
+                            second = val;
+                        }
+                    }
+                    // a single candidate bids as high as the whole cost range allows
+                    if (second == infBenefit) second = best - maxCost - eps;
+                    bidArcs[u] = bestArc;
+                    bidPrices[u] = -costs[bestArc] - second + eps;
+                },
+                numThreads,
+                256);
+            touched.clear();
+            for (int u = 0; u < static_cast<int>(unassigned.size()); ++u) {
+                int j = arcSlots[bidArcs[u]];
+                if (bestBids[j] < 0) {
+                    touched.push_back(j);
+                    bestBids[j] = u;
+                } else if (bidPrices[u] > bidPrices[bestBids[j]]) {
+                    bestBids[j] = u;
+                }
+            }
+            next.clear();
+            for (int j : touched) {
+                int u = bestBids[j], i = unassigned[u];
+                bestBids[j] = -1;
+                if (owners[j] >= 0) {
+                    pointArcs[owners[j]] = -1;
+                    next.push_back(owners[j]);
+                }
+                owners[j] = i;
+                pointArcs[i] = bidArcs[u];
+                prices[j] = bidPrices[u];
+                profits[i] = -costs[bidArcs[u]] - prices[j];
+            }
+            for (int i : unassigned) {
+                if (pointArcs[i] < 0) next.push_back(i);
+            }
+            unassigned.swap(next);
+        }
+
+        // reverse: lower the prices of the unassigned slots to at most lambda (the lowest price of assigned slots)
+        Cost lambda = std::numeric_limits<Cost>::max();
+        for (int j = 0; j < numSlots; ++j) {
+            if (owners[j] >= 0) lambda = std::min(lambda, prices[j]);
+        }
+        queue.clear();
+        for (int j = 0; j < numSlots; ++j) {
+            if (owners[j] < 0 && prices[j] > lambda) queue.push_back(j);
+        }
+        while (!queue.empty()) {
+            int j = queue.back();
+            queue.pop_back();
+            int bestArc = -1;
+            Cost best = infBenefit, second = infBenefit;
+            for (int s = slotBegins[j]; s < slotBegins[j + 1]; ++s) {
+                int a = slotArcs[s];
+                Cost val = -costs[a] - profits[arcPoints[a]];
+                if (val > best) {
+                    second = best;
+                    best = val;
+                    bestArc = a;
+                } else if (val > second) {
+                    second = val;
+                }
+            }
+            if (bestArc < 0 || lambda >= best - eps) {
+                prices[j] = lambda;
+                continue;
+            }
+            int i = arcPoints[bestArc], old = arcSlots[pointArcs[i]];
+            owners[old] = -1;
+            if (prices[old] > lambda) queue.push_back(old);
+            owners[j] = i;
+            pointArcs[i] = bestArc;
+            prices[j] = std::max(lambda, second - eps);
+            profits[i] = -costs[bestArc] - prices[j];
+        }
+        if (eps <= minEps) break;
+        eps = std::max(eps / 5, minEps);
+    }
+    for (int i = 0; i < numPts; ++i) slotIdxs[i] = arcSlots[pointArcs[i]];
+    return slotIdxs;
+}
+
+}  // namespace utils
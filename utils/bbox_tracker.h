@@ -0,0 +1,93 @@
+//
+// Bounding box of a dynamic set of points/boxes, supporting removals (BoxT::Update only grows)
+// Each side is the extreme of a multiset, so insert/remove are O(log n) and the bound is O(1). For incremental
+// half-perimeter wirelength (HPWL) evaluation, MoveDelta() gives the HPWL change of moving one element without
+// modifying the set; it only looks at the two extremes of each side, O(1) amortized.
+//
+// Usage:
+//     BoundingBoxTrackerT<int> net;
+//     for (const auto& pin : pins) net.Insert(pin);
+//     auto delta = net.MoveDelta(pins[0], newLoc);
+//     if (delta < 0) net.Move(pins[0], newLoc);
+//
+
+#pragma once
+
+#include <set>
+
+#include "geo.h"
+
+namespace utils {
+
+template <typename T>
+class BoundingBoxTrackerT {
+public:
+    // points are degenerated boxes
+    void Insert(const PointT<T>& pt) { Insert(BoxT<T>(pt)); }
+    void Insert(const BoxT<T>& box) {
+        for (int d = 0; d < 2; ++d) {
+            _lows[d].insert(box[d].low);
+            _highs[d].insert(box[d].high);
+        }
+    }
+    // false (and no change) if a side of the element is not in the set
+    bool Remove(const PointT<T>& pt) { return Remove(BoxT<T>(pt)); }
+    bool Remove(const BoxT<T>& box) {
+        for (int d = 0; d < 2; ++d) {
+            if (_lows[d].find(box[d].low) == _lows[d].end() || _highs[d].find(box[d].high) == _highs[d].end()) {
+                return false;
+            }
+        }
+        for (int d = 0; d < 2; ++d) {
+            _lows[d].erase(_lows[d].find(box[d].low));
+            _highs[d].erase(_highs[d].find(box[d].high));
+        }
+        return true;
+    }
+    bool Move(const PointT<T>& from, const PointT<T>& to) { return Move(BoxT<T>(from), BoxT<T>(to)); }
+    bool Move(const BoxT<T>& from, const BoxT<T>& to) {
+        if (!Remove(from)) return false;
+        Insert(to);
+        return true;
+    }
+    void Clear() {
+        for (int d = 0; d < 2; ++d) {
+            _lows[d].clear();
+            _highs[d].clear();
+        }
+    }
+
+    size_t size() const { return _lows[0].size(); }
+    bool empty() const { return _lows[0].empty(); }
+    // invalid if empty
+    BoxT<T> bound() const {
+        BoxT<T> box;
+        if (!empty()) box.Set(*_lows[0].begin(), *_lows[1].begin(), *_highs[0].rbegin(), *_highs[1].rbegin());
+        return box;
+    }
+    WideT<T> hp() const { return empty() ? 0 : bound().hp(); }
+
+    // change of hp() if from (assumed in the set) were moved to to, the set is not modified
+    WideT<T> MoveDelta(const PointT<T>& from, const PointT<T>& to) const {
+        return MoveDelta(BoxT<T>(from), BoxT<T>(to));
+    }
+    WideT<T> MoveDelta(const BoxT<T>& from, const BoxT<T>& to) const {
+        WideT<T> delta = 0;
+        for (int d = 0; d < 2; ++d) {
+            // the extremes without from are the first ones, or the second ones if from is the only first one
+            auto low = _lows[d].begin();
+            if (*low == from[d].low) ++low;
+            auto high = _highs[d].rbegin();
+            if (*high == from[d].high) ++high;
+            T newLow = low == _lows[d].end() ? to[d].low : std::min(*low, to[d].low);
+            T newHigh = high == _highs[d].rend() ? to[d].high : std::max(*high, to[d].high);
+            delta += (WideT<T>(newHigh) - newLow) - (WideT<T>(*_highs[d].rbegin()) - *_lows[d].begin());
+        }
+        return delta;
+    }
+
+private:
+    std::multiset<T> _lows[2], _highs[2];  // of x and y
+};
+
+}  // namespace utils
@@ -0,0 +1,266 @@
+//
+// Lazy boolean expressions over box sets
+// BoxSet(a) wraps a std::vector<BoxT<T>> without copying it, and |, &, - and ^ (union, intersection, difference and
+// symmetric difference) build an expression tree at compile time. EvaluateBoxSet() runs one x scanline over the
+// boxes of all operands with a segment tree on y holding a coverage counter per operand, and outputs where the
+// expression holds as disjoint boxes (in the same form as UnionBoxes), without materializing any intermediate set.
+// Degenerated boxes are ignored; the operand vectors must outlive the expression.
+//
+// Usage:
+//     auto boxes = EvaluateBoxSet((BoxSet(a) | BoxSet(b)) & BoxSet(c) - BoxSet(d));
+//
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
+#include "box_set.h"
+
+namespace utils {
+
+template <typename T>
+class BoxSetOperand {
+public:
+    using CoordType = T;
+    static constexpr int numOperands = 1;
+
+    explicit BoxSetOperand(const std::vector<BoxT<T>>& boxes) : _boxes(&boxes) {}
+
+    void CollectOperands(std::vector<const std::vector<BoxT<T>>*>& operands) const { operands.push_back(_boxes); }
+    // bit k of mask: operand k (in order) covers
+    template <int offset>
+    bool Eval(uint32_t mask) const {
+        return (mask >> offset) & 1;
+    }
+
+private:
+    const std::vector<BoxT<T>>* _boxes;
+};
+
+enum class BoxSetOp { Union, Intersect, Subtract, Xor };
+
+template <BoxSetOp op, typename L, typename R>
+class BoxSetExpr {
+public:
+    using CoordType = typename L::CoordType;
+    static constexpr int numOperands = L::numOperands + R::numOperands;
+    static_assert(std::is_same<CoordType, typename R::CoordType>::value, "operands of different coordinate types");
+
+    BoxSetExpr(const L& lhs, const R& rhs) : _lhs(lhs), _rhs(rhs) {}
+
+    void CollectOperands(std::vector<const std::vector<BoxT<CoordType>>*>& operands) const {
+        _lhs.CollectOperands(operands);
+        _rhs.CollectOperands(operands);
+    }
+    template <int offset>
+    bool Eval(uint32_t mask) const {
+        bool lhs = _lhs.template Eval<offset>(mask), rhs = _rhs.template Eval<offset + L::numOperands>(mask);
+        switch (op) {
+            case BoxSetOp::Union:
+                return lhs || rhs;
+            case BoxSetOp::Intersect:
+                return lhs && rhs;
+            case BoxSetOp::Subtract:
+                return lhs && !rhs;
+            default:
+                return lhs != rhs;
+        }
+    }
+
+private:
+    L _lhs;  // by value, the leaves only refer to their vectors
+    R _rhs;
+};
+
+template <typename E>
+struct IsBoxSetExpr : std::false_type {};
+template <typename T>
+struct IsBoxSetExpr<BoxSetOperand<T>> : std::true_type {};
+template <BoxSetOp op, typename L, typename R>
+struct IsBoxSetExpr<BoxSetExpr<op, L, R>> : std::true_type {};
+
+template <typename T>
+BoxSetOperand<T> BoxSet(const std::vector<BoxT<T>>& boxes) {
+    return BoxSetOperand<T>(boxes);
+}
+template <typename T>
+BoxSetOperand<T> BoxSet(const std::vector<BoxT<T>>&& boxes) = delete;  // would dangle
+
+#define UTILS_BOX_SET_OPERATOR(symbol, op)                                                     \
+    template <typename L, typename R>                                                          \
+    std::enable_if_t<IsBoxSetExpr<L>::value && IsBoxSetExpr<R>::value, BoxSetExpr<op, L, R>> \
+    operator symbol(const L& lhs, const R& rhs) {                                              \
+        return BoxSetExpr<op, L, R>(lhs, rhs);                                                 \
+    }
+UTILS_BOX_SET_OPERATOR(|, BoxSetOp::Union)
+UTILS_BOX_SET_OPERATOR(&, BoxSetOp::Intersect)
+UTILS_BOX_SET_OPERATOR(-, BoxSetOp::Subtract)
+UTILS_BOX_SET_OPERATOR(^, BoxSetOp::Xor)
+#undef UTILS_BOX_SET_OPERATOR
+
+// Segment tree over the elementary intervals between sorted unique locations, with a coverage count per operand of a
+// boolean expression (counts stay on the canonical nodes of the added intervals, as in CoverageTreeT). Whether the
+// expression holds in a node range depends on the operands covering its ancestors, so every node keeps two tables
+// over all 2^numOperands masks of them: whether the expression holds somewhere in the range, and whether it fails
+// somewhere. An update is O(numOperands * 2^numOperands / 64 * log n) and a run query is output-sensitive.
+template <typename T, int numOperands>
+class ExprCoverageTreeT {
+public:
+    static_assert(numOperands <= 12, "too many operands for the mask tables");
+
+    // isIn(mask): whether the expression holds where exactly the operands in mask cover
+    template <typename IsIn>
+    ExprCoverageTreeT(std::vector<T> locs, const IsIn& isIn) {
+        std::sort(locs.begin(), locs.end());
+        locs.erase(std::unique(locs.begin(), locs.end()), locs.end());
+        _locs = std::move(locs);
+        _isIns.fill(0);
+        _isOuts.fill(0);
+        for (uint32_t mask = 0; mask < (1u << numOperands); ++mask) {
+            (isIn(mask) ? _isIns : _isOuts)[mask / 64] |= uint64_t(1) << (mask % 64);
+        }
+        size_t numNodes = _locs.size() > 1 ? 4 * (_locs.size() - 1) : 1;
+        _cnts.assign(numNodes * numOperands, 0);
+        _ins.assign(numNodes, _isIns);
+        _outs.assign(numNodes, _isOuts);
+    }
+
+    // add delta to the coverage count of operand over [lo, hi]
+    void Add(T lo, T hi, int operand, int delta) {
+        if (!(lo < hi)) return;
+        Add(1, 0, _locs.size() - 1, GetIdx(lo), GetIdx(hi), operand, delta);
+    }
+
+    // func(lo, hi) on maximal runs where the expression holds, restricted to [lo, hi] (runs are clipped at lo and hi)
+    template <typename Func>
+    void ForEachRun(T lo, T hi, const Func& func) const {
+        if (!(lo < hi) || _locs.size() <= 1) return;
+        size_t runLo = 0, runHi = 0;
+        bool hasRun = false;
+        CollectRuns(1, 0, _locs.size() - 1, GetIdx(lo), GetIdx(hi), 0, [&](size_t l, size_t r) {
+            if (hasRun && runHi == l) {
+                runHi = r;
+                return;
+            }
+            if (hasRun) func(_locs[runLo], _locs[runHi]);
+            hasRun = true;
+            runLo = l;
+            runHi = r;
+        });
+        if (hasRun) func(_locs[runLo], _locs[runHi]);
+    }
+
+private:
+    static constexpr int numWords = numOperands <= 6 ? 1 : 1 << (numOperands - 6);
+    using Table = std::array<uint64_t, numWords>;  // bit mask: for the operands in mask covering the ancestors
+
+    std::vector<T> _locs;
+    std::vector<int> _cnts;          // coverage count of every operand assigned to the node
+    std::vector<Table> _ins, _outs;  // the expression holds/fails somewhere in the node range
+    Table _isIns, _isOuts;           // of a single elementary interval without counts
+
+    size_t GetIdx(T loc) const { return std::lower_bound(_locs.begin(), _locs.end(), loc) - _locs.begin(); }
+    uint32_t GetMask(size_t node) const {
+        uint32_t mask = 0;
+        for (int k = 0; k < numOperands; ++k) mask |= uint32_t(_cnts[node * numOperands + k] > 0) << k;
+        return mask;
+    }
+    static bool Get(const Table& table, uint32_t mask) { return (table[mask / 64] >> (mask % 64)) & 1; }
+    // table[mask] = table[mask | own] for all mask, i.e., the entries of the masks missing an own operand are copied
+    // from the ones having it
+    static void Cover(Table& table, uint32_t own) {
+        static constexpr uint64_t withBits[6] = {0xaaaaaaaaaaaaaaaa,
+                                                 0xcccccccccccccccc,
+                                                 0xf0f0f0f0f0f0f0f0,
+                                                 0xff00ff00ff00ff00,
+                                                 0xffff0000ffff0000,
+                                                 0xffffffff00000000};
+        for (int k = 0; k < numOperands; ++k) {
+            if (!((own >> k) & 1)) continue;
+            if (k < 6) {
+                for (auto& word : table) word = (word & withBits[k]) | ((word & withBits[k]) >> (1 << k));
+            } else {
+                for (int w = 0; w < numWords; ++w) {
+                    if (!(w & (1 << (k - 6)))) table[w] = table[w | (1 << (k - 6))];
+                }
+            }
+        }
+    }
+
+    // node covers elementary intervals [l, r) (i.e., locations _locs[l] to _locs[r])
+    void Add(size_t node, size_t l, size_t r, size_t ql, size_t qr, int operand, int delta) {
+        if (qr <= l || r <= ql) return;
+        if (ql <= l && r <= qr) {
+            _cnts[node * numOperands + operand] += delta;
+        } else {
+            size_t mid = (l + r) / 2;
+            Add(node * 2, l, mid, ql, qr, operand, delta);
+            Add(node * 2 + 1, mid, r, ql, qr, operand, delta);
+        }
+        if (r - l == 1) {
+            _ins[node] = _isIns;
+            _outs[node] = _isOuts;
+        } else {
+            for (int w = 0; w < numWords; ++w) {
+                _ins[node][w] = _ins[node * 2][w] | _ins[node * 2 + 1][w];
+                _outs[node][w] = _outs[node * 2][w] | _outs[node * 2 + 1][w];
+            }
+        }
+        uint32_t own = GetMask(node);
+        Cover(_ins[node], own);
+        Cover(_outs[node], own);
+    }
+
+    // func(l, r) on elementary index ranges where the expression holds in increasing order, mask: of the ancestors
+    template <typename Func>
+    void CollectRuns(size_t node, size_t l, size_t r, size_t ql, size_t qr, uint32_t mask, const Func& func) const {
+        if (qr <= l || r <= ql || !Get(_ins[node], mask)) return;
+        if (!Get(_outs[node], mask)) {
+            func(std::max(l, ql), std::min(r, qr));
+            return;
+        }
+        size_t mid = (l + r) / 2;
+        mask |= GetMask(node);
+        CollectRuns(node * 2, l, mid, ql, qr, mask, func);
+        CollectRuns(node * 2 + 1, mid, r, ql, qr, mask, func);
+    }
+};
+
+// Region of expr as disjoint boxes, by a single scanline pass
+// Each output box is a maximal y run where expr holds, over an x range where the run does not change (StitchRuns(),
+// as in UnionBoxes): an event only revisits the runs touching its y range, in O((k + 1) log n) for k runs. The same vector may
+// appear in several leaves, each leaf has its own counter.
+template <typename Expr, typename = std::enable_if_t<IsBoxSetExpr<Expr>::value>>
+std::vector<BoxT<typename Expr::CoordType>> EvaluateBoxSet(const Expr& expr) {
+    using T = typename Expr::CoordType;
+    constexpr int numOperands = Expr::numOperands;
+    std::vector<const std::vector<BoxT<T>>*> operands;
+    expr.CollectOperands(operands);
+
+    struct Event {
+        T x, lo, hi;
+        int operand, delta;
+    };
+    std::vector<Event> events;
+    std::vector<T> ys;
+    for (int k = 0; k < numOperands; ++k) {
+        for (const auto& box : *operands[k]) {
+            if (!box.IsStrictValid()) continue;
+            events.push_back({box.lx(), box.ly(), box.hy(), k, 1});
+            events.push_back({box.hx(), box.ly(), box.hy(), k, -1});
+            ys.push_back(box.ly());
+            ys.push_back(box.hy());
+        }
+    }
+    std::sort(events.begin(), events.end(), [](const Event& lhs, const Event& rhs) { return lhs.x < rhs.x; });
+    ExprCoverageTreeT<T, numOperands> tree(move(ys), [&](uint32_t mask) { return expr.template Eval<0>(mask); });
+
+    return StitchRuns<T>(
+        events,
+        [&](const Event& event) { tree.Add(event.lo, event.hi, event.operand, event.delta); },
+        [&](T lo, T hi, const auto& func) { tree.ForEachRun(lo, hi, func); });
+}
+
+}  // namespace utils
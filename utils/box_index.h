@@ -0,0 +1,106 @@
+//
+// Static spatial index over a box set
+// BoxGridIndexT: uniform bucket grid (CSR storage), each box is registered in every cell it overlaps and is reported
+// once per query by checking the cell of its reference point (lower-left corner of box & window intersection).
+//
+
+#pragma once
+
+#include <cmath>
+
+#include "geo.h"
+
+namespace utils {
+
+template <typename T>
+class BoxGridIndexT {
+public:
+    BoxGridIndexT() = default;
+    BoxGridIndexT(const std::vector<BoxT<T>>& boxes, double cellSize = 0) { Build(boxes, cellSize); }
+
+    // cellSize <= 0 derives it from the average box size and the density
+    void Build(const std::vector<BoxT<T>>& boxes, double cellSize = 0) {
+        _boxes = boxes;
+        _cellBegins.assign(1, 0);
+        _boxIdxs.clear();
+        _bound.Set();
+        double sumSize = 0;
+        for (const auto& box : _boxes) {
+            if (!box.IsValid()) continue;
+            _bound = _bound.UnionWith(box);
+            sumSize += static_cast<double>(box.width()) + box.height();
+        }
+        if (!_bound.IsValid()) return;
+
+        // grid size (at most ~4 cells per box)
+        double width = static_cast<double>(_bound.width()), height = static_cast<double>(_bound.height());
+        if (cellSize <= 0) {
+            cellSize = std::max(sumSize / (2 * _boxes.size()), std::sqrt(width * height / _boxes.size()));
+        }
+        double maxNumCells = 4.0 * _boxes.size() + 16;
+        cellSize = std::max({cellSize, std::sqrt(width * height / maxNumCells), std::max(width, height) / maxNumCells});
+        _cellSize = cellSize > 0 ? cellSize : 1.0;
+        _numCols = static_cast<int>(width / _cellSize) + 1;
+        _numRows = static_cast<int>(height / _cellSize) + 1;
+
+        // CSR of box indices per cell
+        std::vector<int> counts(_numCols * _numRows + 1, 0);
+        auto forEachCell = [&](const BoxT<T>& box, auto&& func) {
+            int hc = GetCol(box.hx()), hr = GetRow(box.hy());
+            for (int r = GetRow(box.ly()); r <= hr; ++r) {
+                for (int c = GetCol(box.lx()); c <= hc; ++c) func(r * _numCols + c);
+            }
+        };
+        for (const auto& box : _boxes) {
+            if (box.IsValid()) forEachCell(box, [&](int cell) { ++counts[cell + 1]; });
+        }
+        for (size_t i = 1; i < counts.size(); ++i) counts[i] += counts[i - 1];
+        _cellBegins = counts;
+        _boxIdxs.resize(counts.back());
+        for (int i = 0; i < static_cast<int>(_boxes.size()); ++i) {
+            if (_boxes[i].IsValid()) forEachCell(_boxes[i], [&](int cell) { _boxIdxs[counts[cell]++] = i; });
+        }
+    }
+
+    // func(boxIdx) for every box intersecting window (closed intersection), each box reported once
+    template <typename Func>
+    void Query(const BoxT<T>& window, const Func& func) const {
+        if (!_bound.IsValid() || !window.HasIntersectWith(_bound)) return;
+        int lc = GetCol(window.lx()), hc = GetCol(window.hx()), lr = GetRow(window.ly()), hr = GetRow(window.hy());
+        for (int r = lr; r <= hr; ++r) {
+            for (int c = lc; c <= hc; ++c) {
+                int cell = r * _numCols + c;
+                for (int k = _cellBegins[cell]; k < _cellBegins[cell + 1]; ++k) {
+                    int i = _boxIdxs[k];
+                    const auto& box = _boxes[i];
+                    if (!box.HasIntersectWith(window)) continue;
+                    if (GetCol(std::max(box.lx(), window.lx())) == c && GetRow(std::max(box.ly(), window.ly())) == r) {
+                        func(i);
+                    }
+                }
+            }
+        }
+    }
+
+    const std::vector<BoxT<T>>& boxes() const { return _boxes; }
+    const BoxT<T>& bound() const { return _bound; }
+
+private:
+    std::vector<BoxT<T>> _boxes;
+    BoxT<T> _bound;
+    double _cellSize = 1.0;
+    int _numCols = 0, _numRows = 0;
+    std::vector<int> _cellBegins;  // CSR offsets into _boxIdxs per cell
+    std::vector<int> _boxIdxs;
+
+    int GetCol(T x) const {
+        double c = std::floor((static_cast<double>(x) - _bound.lx()) / _cellSize);
+        return c < 0 ? 0 : (c >= _numCols ? _numCols - 1 : static_cast<int>(c));
+    }
+    int GetRow(T y) const {
+        double r = std::floor((static_cast<double>(y) - _bound.ly()) / _cellSize);
+        return r < 0 ? 0 : (r >= _numRows ? _numRows - 1 : static_cast<int>(r));
+    }
+};
+
+}  // namespace utils
@@ -0,0 +1,392 @@
+//
+// Batch operations on box sets (std::vector<BoxT<T>>)
+// 1. BloatBoxes/BloatBoxSet: bloat (or shrink) every box, or the region covered by the boxes
+// 2. UnionBoxes/ComplementBoxes/UnionArea: scanline union (or complement) into disjoint boxes and the union area
+// 3. FindSpacingViolations: all pairs of boxes closer than a spacing under L-1/L-2/L-inf
+//
+
+#pragma once
+
+#include <cmath>
+#include <iterator>
+#include <map>
+#include <queue>
+#include <set>
+#include <utility>
+
+#include "geo.h"
+
+namespace utils {
+
+// Segment tree over the elementary intervals between sorted unique locations, counting how many times each of them
+// is covered. It is the core of the scanline (line sweep) routines on box sets.
+template <typename T>
+class CoverageTreeT {
+public:
+    CoverageTreeT() = default;
+    CoverageTreeT(std::vector<T> locs) { Init(std::move(locs)); }
+
+    // locs: boundaries of all intervals that will be added (need not be sorted or unique)
+    void Init(std::vector<T> locs) {
+        std::sort(locs.begin(), locs.end());
+        locs.erase(std::unique(locs.begin(), locs.end()), locs.end());
+        _locs = std::move(locs);
+        size_t numNodes = _locs.size() > 1 ? 4 * (_locs.size() - 1) : 1;
+        _cnt.assign(numNodes, 0);
+        _len.assign(numNodes, 0);
+        _full.assign(numNodes, false);
+    }
+
+    // add delta to the coverage count of [lo, hi]
+    void Add(T lo, T hi, int delta) {
+        if (!(lo < hi)) return;
+        Add(1, 0, _locs.size() - 1, GetIdx(lo), GetIdx(hi), delta);
+    }
+
+    // total length covered (count > 0)
+    WideT<T> coveredLength() const { return _locs.size() > 1 ? _len[1] : 0; }
+
+    // func(lo, hi) on maximal covered runs, restricted to [lo, hi] (runs are clipped at lo and hi)
+    template <typename Func>
+    void ForEachCoveredRun(T lo, T hi, const Func& func) const {
+        if (!(lo < hi) || _locs.size() <= 1) return;
+        size_t runLo = 0, runHi = 0;
+        bool hasRun = false;
+        CollectRuns(1, 0, _locs.size() - 1, GetIdx(lo), GetIdx(hi), [&](size_t l, size_t r) {
+            if (hasRun && runHi == l) {
+                runHi = r;
+                return;
+            }
+            if (hasRun) func(_locs[runLo], _locs[runHi]);
+            hasRun = true;
+            runLo = l;
+            runHi = r;
+        });
+        if (hasRun) func(_locs[runLo], _locs[runHi]);
+    }
+
+private:
+    std::vector<T> _locs;
+    std::vector<int> _cnt;       // coverage count assigned to the node
+    std::vector<WideT<T>> _len;  // covered length in the node range
+    std::vector<char> _full;     // node range is fully covered
+
+    size_t GetIdx(T loc) const { return std::lower_bound(_locs.begin(), _locs.end(), loc) - _locs.begin(); }
+
+    // node covers elementary intervals [l, r) (i.e., locations _locs[l] to _locs[r])
+    void Add(size_t node, size_t l, size_t r, size_t ql, size_t qr, int delta) {
+        if (qr <= l || r <= ql) return;
+        if (ql <= l && r <= qr) {
+            _cnt[node] += delta;
+        } else {
+            size_t mid = (l + r) / 2;
+            Add(node * 2, l, mid, ql, qr, delta);
+            Add(node * 2 + 1, mid, r, ql, qr, delta);
+        }
+        if (_cnt[node] > 0) {
+            _len[node] = WideT<T>(_locs[r]) - _locs[l];
+            _full[node] = true;
+        } else if (r - l == 1) {
+            _len[node] = 0;
+            _full[node] = false;
+        } else {
+            _len[node] = _len[node * 2] + _len[node * 2 + 1];
+            _full[node] = _full[node * 2] && _full[node * 2 + 1];
+        }
+    }
+
+    // func(l, r) on covered elementary index ranges in increasing order
+    template <typename Func>
+    void CollectRuns(size_t node, size_t l, size_t r, size_t ql, size_t qr, const Func& func) const {
+        if (qr <= l || r <= ql || _len[node] == 0) return;
+        if (_full[node]) {
+            func(std::max(l, ql), std::min(r, qr));
+            return;
+        }
+        size_t mid = (l + r) / 2;
+        CollectRuns(node * 2, l, mid, ql, qr, func);
+        CollectRuns(node * 2 + 1, mid, r, ql, qr, func);
+    }
+};
+
+// Boxes crossing a sweep line by ly, bucketed by height class (heights in [2^(c-1), 2^c) for class c), so that a y
+// window query starts each bucket from lo - (max height in the bucket) instead of lo - (max height of all boxes).
+// A few tall boxes (e.g., power stripes, macros, die outline) then no longer turn every query into a full scan.
+template <typename T>
+class ActiveBoxSetT {
+public:
+    explicit ActiveBoxSetT(const std::vector<BoxT<T>>& boxes) : _boxes(boxes) {}
+
+    void Insert(int i) {
+        auto& bucket = _buckets[HeightClass(_boxes[i].height())];
+        bucket.first = std::max(bucket.first, _boxes[i].height());
+        bucket.second.emplace(_boxes[i].ly(), i);
+    }
+    void Erase(int i) { _buckets[HeightClass(_boxes[i].height())].second.erase({_boxes[i].ly(), i}); }
+
+    // func(i) on the active boxes whose y ranges intersect [lo, hi] (closed)
+    template <typename Func>
+    void ForEachInRange(T lo, T hi, const Func& func) const {
+        for (const auto& bucket : _buckets) {
+            const auto& actives = bucket.second.second;
+            auto it = actives.lower_bound({lo - bucket.second.first, std::numeric_limits<int>::min()});
+            for (; it != actives.end() && it->first <= hi; ++it) {
+                if (_boxes[it->second].hy() >= lo) func(it->second);
+            }
+        }
+    }
+
+private:
+    const std::vector<BoxT<T>>& _boxes;
+    std::map<int, std::pair<T, std::set<std::pair<T, int>>>> _buckets;  // class -> (max height, {(ly, box idx)})
+
+    template <typename U = T>
+    static std::enable_if_t<std::is_integral<U>::value, int> HeightClass(U height) {
+        int heightClass = 0;
+        for (; height > 0; height /= 2) ++heightClass;
+        return heightClass;
+    }
+    template <typename U = T>
+    static std::enable_if_t<!std::is_integral<U>::value, int> HeightClass(U height) {
+        int exp = 0;
+        std::frexp(height, &exp);
+        return height > 0 ? exp : std::numeric_limits<int>::min();
+    }
+};
+
+// Bloat every box by amount on all four sides (negative amount shrinks; boxes shrunk to zero width or height are
+// removed)
+// Note: boxes are sized individually, see BloatBoxSet() to size the region they cover.
+template <typename T>
+void BloatBoxes(std::vector<BoxT<T>>& boxes, T amount) {
+    for (auto& box : boxes) box.Set(box.lx() - amount, box.ly() - amount, box.hx() + amount, box.hy() + amount);
+    if (amount < 0) {
+        boxes.erase(
+            std::remove_if(boxes.begin(), boxes.end(), [](const BoxT<T>& box) { return !box.IsStrictValid(); }),
+            boxes.end());
+    }
+}
+
+// Scanline stitching of the runs of a cross section into boxes (the core of UnionBoxes() and EvaluateBoxSet())
+// events (with x, lo and hi, sorted by x) are applied by add(event) to a coverage structure, whose forEachRun(lo, hi,
+// func) calls func(runLo, runHi) on the maximal runs of the current cross section clipped to [lo, hi]. Each output box
+// is a run over an x range where it does not change; the events at an x only revisit the runs touching their y ranges.
+template <typename T, typename Event, typename Add, typename ForEachRun>
+std::vector<BoxT<T>> StitchRuns(const std::vector<Event>& events, const Add& add, const ForEachRun& forEachRun) {
+    std::vector<BoxT<T>> result;
+    std::map<T, std::pair<T, T>> openRuns;  // lo -> (hi, start x) of the runs in the current cross section
+    std::vector<std::pair<T, std::pair<T, T>>> oldRuns;
+    std::vector<std::pair<T, T>> ranges, newRuns;
+    auto closeRun = [&](const std::pair<T, std::pair<T, T>>& run, T x) {
+        if (run.second.second < x) result.emplace_back(run.second.second, run.first, x, run.second.first);
+    };
+    for (size_t i = 0; i < events.size();) {
+        T x = events[i].x;
+        ranges.clear();
+        for (; i < events.size() && events[i].x == x; ++i) {
+            add(events[i]);
+            ranges.emplace_back(events[i].lo, events[i].hi);
+        }
+        std::sort(ranges.begin(), ranges.end());
+        for (size_t j = 0; j < ranges.size();) {
+            // merged range of changes
+            T lo = ranges[j].first, hi = ranges[j].second;
+            for (++j; j < ranges.size() && ranges[j].first <= hi; ++j) hi = std::max(hi, ranges[j].second);
+            // extend to the open runs touching it, and close them
+            auto it = openRuns.upper_bound(hi);
+            while (it != openRuns.begin() && std::prev(it)->second.first >= lo) {
+                --it;
+                lo = std::min(lo, it->first);
+                hi = std::max(hi, it->second.first);
+            }
+            oldRuns.clear();
+            while (it != openRuns.end() && it->first <= hi) {
+                oldRuns.push_back(*it);
+                it = openRuns.erase(it);
+            }
+            // reopen the new runs (unchanged runs keep their start x) and output the closed ones
+            newRuns.clear();
+            forEachRun(lo, hi, [&](T runLo, T runHi) { newRuns.emplace_back(runLo, runHi); });
+            size_t k = 0;
+            for (const auto& run : newRuns) {
+                for (; k < oldRuns.size() && oldRuns[k].first < run.first; ++k) closeRun(oldRuns[k], x);
+                if (k < oldRuns.size() && oldRuns[k].first == run.first && oldRuns[k].second.first == run.second) {
+                    openRuns.insert(it, oldRuns[k++]);
+                } else {
+                    openRuns.emplace_hint(it, run.first, std::make_pair(run.second, x));
+                }
+            }
+            for (; k < oldRuns.size(); ++k) closeRun(oldRuns[k], x);
+        }
+    }
+    return result;
+}
+
+// Union of boxes as disjoint boxes (degenerated boxes are ignored)
+// Sweep along x with a coverage tree on y; each output box is a maximal covered y run over an x range where it does
+// not change. O((n + k) log n) for n input and k output boxes.
+template <typename T>
+std::vector<BoxT<T>> UnionBoxes(const std::vector<BoxT<T>>& boxes) {
+    struct Event {
+        T x, lo, hi;
+        int delta;
+    };
+    std::vector<Event> events;
+    std::vector<T> ys;
+    for (const auto& box : boxes) {
+        if (!box.IsStrictValid()) continue;
+        events.push_back({box.lx(), box.ly(), box.hy(), 1});
+        events.push_back({box.hx(), box.ly(), box.hy(), -1});
+        ys.push_back(box.ly());
+        ys.push_back(box.hy());
+    }
+    std::sort(events.begin(), events.end(), [](const Event& lhs, const Event& rhs) { return lhs.x < rhs.x; });
+    CoverageTreeT<T> tree(move(ys));
+    return StitchRuns<T>(
+        events,
+        [&](const Event& event) { tree.Add(event.lo, event.hi, event.delta); },
+        [&](T lo, T hi, const auto& func) { tree.ForEachCoveredRun(lo, hi, func); });
+}
+
+// Region of frame not covered by boxes, as disjoint boxes (in the same form as UnionBoxes)
+template <typename T>
+std::vector<BoxT<T>> ComplementBoxes(const std::vector<BoxT<T>>& boxes, const BoxT<T>& frame) {
+    struct Event {
+        T x, lo, hi;
+        int delta;
+        bool isFrame;
+    };
+    if (!frame.IsStrictValid()) return {};
+    std::vector<Event> events = {{frame.lx(), frame.ly(), frame.hy(), 1, true},
+                                 {frame.hx(), frame.ly(), frame.hy(), -1, true}};
+    std::vector<T> ys = {frame.ly(), frame.hy()};
+    for (const auto& box : boxes) {
+        if (!box.IsStrictValid()) continue;
+        events.push_back({box.lx(), box.ly(), box.hy(), 1, false});
+        events.push_back({box.hx(), box.ly(), box.hy(), -1, false});
+        ys.push_back(box.ly());
+        ys.push_back(box.hy());
+    }
+    std::sort(events.begin(), events.end(), [](const Event& lhs, const Event& rhs) { return lhs.x < rhs.x; });
+    CoverageTreeT<T> tree(move(ys));
+    bool isInFrame = false;
+    return StitchRuns<T>(
+        events,
+        [&](const Event& event) {
+            if (event.isFrame) {
+                isInFrame = event.delta > 0;
+            } else {
+                tree.Add(event.lo, event.hi, event.delta);
+            }
+        },
+        [&](T lo, T hi, const auto& func) {
+            if (!isInFrame) return;
+            lo = std::max(lo, frame.ly());
+            hi = std::min(hi, frame.hy());
+            T gapLo = lo;
+            tree.ForEachCoveredRun(lo, hi, [&](T runLo, T runHi) {
+                if (gapLo < runLo) func(gapLo, runLo);
+                gapLo = runHi;
+            });
+            if (gapLo < hi) func(gapLo, hi);
+        });
+}
+
+// Bloat (or shrink, for a negative amount) the region covered by boxes, as disjoint boxes
+// Bloating is the union of the bloated boxes. Shrinking bloats the complement of the region (within its bound bloated
+// by -amount) and takes it out, so that the seams between touching boxes do not open as with BloatBoxes().
+template <typename T>
+std::vector<BoxT<T>> BloatBoxSet(const std::vector<BoxT<T>>& boxes, T amount) {
+    if (!(amount < 0)) {
+        std::vector<BoxT<T>> bloated = boxes;
+        BloatBoxes(bloated, amount);
+        return UnionBoxes(bloated);
+    }
+    auto region = UnionBoxes(boxes);
+    if (region.empty()) return region;
+    BoxT<T> frame;
+    for (const auto& box : region) frame = frame.UnionWith(box);
+    frame.Set(frame.lx() + amount, frame.ly() + amount, frame.hx() - amount, frame.hy() - amount);
+    auto outside = ComplementBoxes(region, frame);
+    BloatBoxes(outside, -amount);
+    return ComplementBoxes(outside, frame);
+}
+
+// Area of the union of boxes (in the wide type, exact for integers)
+template <typename T>
+WideT<T> UnionArea(const std::vector<BoxT<T>>& boxes) {
+    using Event = std::pair<T, const BoxT<T>*>;  // (x, box)
+    std::vector<Event> events;
+    std::vector<T> ys;
+    for (const auto& box : boxes) {
+        if (!box.IsStrictValid()) continue;
+        events.emplace_back(box.lx(), &box);
+        events.emplace_back(box.hx(), &box);
+        ys.push_back(box.ly());
+        ys.push_back(box.hy());
+    }
+    std::sort(events.begin(), events.end(), [](const Event& lhs, const Event& rhs) { return lhs.first < rhs.first; });
+    CoverageTreeT<T> tree(move(ys));
+    WideT<T> area = 0;
+    for (size_t i = 0; i < events.size(); ++i) {
+        if (i > 0) area += tree.coveredLength() * (WideT<T>(events[i].first) - events[i - 1].first);
+        const auto& box = *events[i].second;
+        tree.Add(box.ly(), box.hy(), events[i].first == box.lx() ? 1 : -1);
+    }
+    return area;
+}
+
+// Distance between boxes under metric, compared with spacing without sqrt (exact for integers)
+template <typename T>
+inline bool IsCloserThan(const BoxT<T>& box1, const BoxT<T>& box2, T spacing, DistMetric metric) {
+    WideT<T> dx = Dist(box1.x, box2.x), dy = Dist(box1.y, box2.y);
+    switch (metric) {
+        case DistMetric::L1:
+            return dx + dy < spacing;
+        case DistMetric::LInf:
+            return std::max(dx, dy) < spacing;
+        default:
+            return dx * dx + dy * dy < WideT<T>(spacing) * spacing;
+    }
+}
+
+// All pairs (i, j), i < j, of boxes closer than spacing (strictly) under metric
+// Touching/overlapping pairs (distance 0) are reported only if includeTouching is set.
+// Sweep along x with an active window of boxes whose hx is within spacing, bucketed by height class (ActiveBoxSetT),
+// so it is near-linear for layouts even with a few tall boxes.
+template <typename T>
+std::vector<std::pair<int, int>> FindSpacingViolations(const std::vector<BoxT<T>>& boxes,
+                                                       T spacing,
+                                                       DistMetric metric = DistMetric::LInf,
+                                                       bool includeTouching = false) {
+    std::vector<std::pair<int, int>> violations;
+    std::vector<int> order;
+    for (int i = 0; i < static_cast<int>(boxes.size()); ++i) {
+        if (boxes[i].IsValid()) order.push_back(i);
+    }
+    std::sort(order.begin(), order.end(), [&](int lhs, int rhs) { return boxes[lhs].lx() < boxes[rhs].lx(); });
+
+    ActiveBoxSetT<T> active(boxes);
+    auto cmpExpire = [&](int lhs, int rhs) { return boxes[lhs].hx() > boxes[rhs].hx(); };
+    std::priority_queue<int, std::vector<int>, decltype(cmpExpire)> toExpire(cmpExpire);
+    for (int i : order) {
+        const auto& box = boxes[i];
+        // expire boxes that are at least spacing away in x
+        while (!toExpire.empty() && box.lx() - boxes[toExpire.top()].hx() >= spacing) {
+            active.Erase(toExpire.top());
+            toExpire.pop();
+        }
+        // query boxes in the distance-expanded y window
+        active.ForEachInRange(box.ly() - spacing, box.hy() + spacing, [&](int j) {
+            const auto& other = boxes[j];
+            if (!IsCloserThan(box, other, spacing, metric)) return;
+            if (!includeTouching && box.HasIntersectWith(other)) return;
+            violations.emplace_back(std::min(i, j), std::max(i, j));
+        });
+        active.Insert(i);
+        toExpire.push(i);
+    }
+    return violations;
+}
+
+}  // namespace utils
@@ -0,0 +1,242 @@
+//
+// Clustering of point sets
+// 1. Dbscan: density-based clustering with grid-accelerated epsilon-neighborhood search
+// 2. Kmeans: k-means (Lloyd) with k-means++ seeding and multi-threaded assignment/update
+//
+
+#pragma once
+
+#include <random>
+
+#include "geo.h"
+#include "parallel.h"
+#include "point_grid.h"
+#include "union_find.h"
+
+namespace utils {
+
+template <typename T>
+struct DbscanResult {
+    std::vector<int> labels;            // cluster index of each point (-1 for noise)
+    std::vector<BoxT<T>> clusterBoxes;  // bounding box of each cluster
+    size_t numClusters() const { return clusterBoxes.size(); }
+};
+
+// DBSCAN of points with neighborhood radius eps (inclusive) and density threshold minPts (point itself counted)
+// Core points within eps are merged by a parallel union-find; a border point joins the cluster of its core neighbor
+// with the smallest index. Clusters are numbered by their smallest point index, so the result is deterministic.
+template <typename T>
+DbscanResult<T> Dbscan(const std::vector<PointT<T>>& points,
+                       T eps,
+                       int minPts,
+                       DistMetric metric = DistMetric::L2,
+                       int numThreads = 0) {
+    DbscanResult<T> result;
+    int numPts = points.size();
+    result.labels.assign(numPts, -1);
+    if (numPts == 0) return result;
+
+    PointGridT<T> grid(points, eps);
+    const auto& idxs = grid.pointIdxs();
+    auto forEachPoint = [&](const auto& func) {  // func(cellIdx, pointIdx), parallel over cells
+        ParallelFor(
+            0,
+            grid.numCells(),
+            [&](size_t c) {
+                for (int i = grid.cell(c).begin; i < grid.cell(c).end; ++i) func(c, idxs[i]);
+            },
+            numThreads,
+            16);
+    };
+    auto forEachNeighbor = [&](int cellIdx, int i, const auto& func) {  // func(j) for j within eps of i
+        grid.ForEachNeighborCell(cellIdx, [&](int c) {
+            for (int k = grid.cell(c).begin; k < grid.cell(c).end; ++k) {
+                int j = idxs[k];
+                if (IsWithinDist(points[i], points[j], eps, metric)) func(j);
+            }
+        });
+    };
+
+    // 1. core points
+    std::vector<char> isCore(numPts, false);
+    forEachPoint([&](int c, int i) {
+        int numNeighbors = 0;
+        forEachNeighbor(c, i, [&](int) { ++numNeighbors; });
+        isCore[i] = numNeighbors >= minPts;
+    });
+
+    // 2. merge core points within eps
+    UnionFind uf(numPts);
+    forEachPoint([&](int c, int i) {
+        if (!isCore[i]) return;
+        forEachNeighbor(c, i, [&](int j) {
+            if (j > i && isCore[j]) uf.Union(i, j);
+        });
+    });
+
+    // 3. attach border points to their smallest-index core neighbor
+    std::vector<int> roots(numPts, -1);
+    forEachPoint([&](int c, int i) {
+        if (isCore[i]) {
+            roots[i] = uf.Find(i);
+            return;
+        }
+        int coreNeighbor = numPts;
+        forEachNeighbor(c, i, [&](int j) {
+            if (isCore[j]) coreNeighbor = std::min(coreNeighbor, j);
+        });
+        if (coreNeighbor < numPts) roots[i] = uf.Find(coreNeighbor);
+    });
+
+    // 4. compact labels & bounding boxes
+    std::vector<int> rootToCluster(numPts, -1);
+    for (int i = 0; i < numPts; ++i) {
+        if (roots[i] == -1) continue;
+        int& cluster = rootToCluster[roots[i]];
+        if (cluster == -1) {
+            cluster = result.clusterBoxes.size();
+            result.clusterBoxes.emplace_back();
+        }
+        result.labels[i] = cluster;
+        result.clusterBoxes[cluster].Update(points[i]);
+    }
+    return result;
+}
+
+struct KmeansResult {
+    std::vector<int> labels;              // cluster index of each point
+    std::vector<PointT<double>> centers;  // centroid of each cluster
+    int numIters = 0;                     // number of Lloyd iterations run
+};
+
+// K-means of points into k clusters (k is capped by the number of points)
+// Centroids are kept in SoA form and the assignment step works on blocks of points with squared distances, which
+// compilers vectorize. Iterations stop after maxIters or once fewer than minChanges points change cluster.
+template <typename T>
+KmeansResult Kmeans(const std::vector<PointT<T>>& points,
+                    int k,
+                    int maxIters = 100,
+                    size_t minChanges = 1,
+                    unsigned seed = 0,
+                    int numThreads = 0) {
+    KmeansResult result;
+    size_t numPts = points.size();
+    k = std::min<size_t>(std::max(k, 0), numPts);
+    result.labels.assign(numPts, 0);
+    if (k == 0) return result;
+
+    // SoA copies of points and centroids
+    std::vector<double> px(numPts), py(numPts), cx(k), cy(k);
+    for (size_t i = 0; i < numPts; ++i) {
+        px[i] = points[i].x;
+        py[i] = points[i].y;
+    }
+    numThreads = GetNumThreads(numThreads);
+
+    // 1. k-means++ seeding
+    std::mt19937_64 rng(seed);
+    std::vector<double> minDist2(numPts, std::numeric_limits<double>::infinity());
+    size_t first = std::uniform_int_distribution<size_t>(0, numPts - 1)(rng);
+    cx[0] = px[first];
+    cy[0] = py[first];
+    for (int c = 1; c < k; ++c) {
+        double lastX = cx[c - 1], lastY = cy[c - 1];
+        std::vector<double> sums(numThreads, 0);
+        ParallelForRange(
+            0,
+            numPts,
+            [&](int t, size_t lo, size_t hi) {
+                double sum = 0;
+                for (size_t i = lo; i < hi; ++i) {
+                    double dx = px[i] - lastX, dy = py[i] - lastY;
+                    minDist2[i] = std::min(minDist2[i], dx * dx + dy * dy);
+                    sum += minDist2[i];
+                }
+                sums[t] = sum;
+            },
+            numThreads);
+        double total = 0;
+        for (double sum : sums) total += sum;
+        size_t chosen = 0;
+        if (total > 0) {  // sample with probability proportional to squared distance
+            double target = std::uniform_real_distribution<double>(0, total)(rng);
+            while (chosen + 1 < numPts && (target -= minDist2[chosen]) >= 0) ++chosen;
+            while (minDist2[chosen] == 0) --chosen;  // never pick an existing center
+        } else {  // all points coincide with centers
+            chosen = c;
+        }
+        cx[c] = px[chosen];
+        cy[c] = py[chosen];
+    }
+
+    // 2. Lloyd iterations
+    const size_t blockSize = 256;
+    std::vector<std::vector<double>> sumX(numThreads), sumY(numThreads);
+    std::vector<std::vector<size_t>> counts(numThreads);
+    std::vector<size_t> numChanges(numThreads);
+    for (result.numIters = 1; result.numIters <= maxIters; ++result.numIters) {
+        for (int t = 0; t < numThreads; ++t) {
+            sumX[t].assign(k, 0);
+            sumY[t].assign(k, 0);
+            counts[t].assign(k, 0);
+            numChanges[t] = 0;
+        }
+        ParallelForRange(
+            0,
+            numPts,
+            [&](int t, size_t lo, size_t hi) {
+                double bestDist2[blockSize];
+                int bestLabel[blockSize];
+                for (size_t begin = lo; begin < hi; begin += blockSize) {
+                    size_t num = std::min(blockSize, hi - begin);
+                    const double* bx = &px[begin];
+                    const double* by = &py[begin];
+                    std::fill(bestDist2, bestDist2 + num, std::numeric_limits<double>::infinity());
+                    for (int c = 0; c < k; ++c) {
+                        double ccx = cx[c], ccy = cy[c];
+                        for (size_t i = 0; i < num; ++i) {  // vectorizable
+                            double dx = bx[i] - ccx, dy = by[i] - ccy;
+                            double dist2 = dx * dx + dy * dy;
+                            bool closer = dist2 < bestDist2[i];
+                            bestDist2[i] = closer ? dist2 : bestDist2[i];
+                            bestLabel[i] = closer ? c : bestLabel[i];
+                        }
+                    }
+                    for (size_t i = 0; i < num; ++i) {
+                        int& label = result.labels[begin + i];
+                        if (label != bestLabel[i] || result.numIters == 1) ++numChanges[t];
+                        label = bestLabel[i];
+                        sumX[t][label] += bx[i];
+                        sumY[t][label] += by[i];
+                        ++counts[t][label];
+                    }
+                }
+            },
+            numThreads);
+
+        // reduce per-thread partial sums into new centroids (empty clusters keep their centroid)
+        size_t totalChanges = 0;
+        for (int c = 0; c < k; ++c) {
+            double x = 0, y = 0;
+            size_t count = 0;
+            for (int t = 0; t < numThreads; ++t) {
+                x += sumX[t][c];
+                y += sumY[t][c];
+                count += counts[t][c];
+            }
+            if (count > 0) {
+                cx[c] = x / count;
+                cy[c] = y / count;
+            }
+        }
+        for (int t = 0; t < numThreads; ++t) totalChanges += numChanges[t];
+        if (totalChanges < minChanges) break;
+    }
+    result.numIters = std::min(result.numIters, maxIters);
+
+    result.centers.resize(k);
+    for (int c = 0; c < k; ++c) result.centers[c] = {cx[c], cy[c]};
+    return result;
+}
+
+}  // namespace utils
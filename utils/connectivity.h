@@ -0,0 +1,127 @@
+//
+// Connected components of touching/overlapping boxes (e.g., the shapes forming one electrical net)
+// Touching pairs are found by an x sweep as in FindSpacingViolations (with the active boxes bucketed by height class).
+// The boxes sorted by lx are cut into one contiguous strip per thread, each thread sweeps its strip (seeded with the
+// earlier boxes reaching into it) and merges the pairs it finds with the lock-free UnionFind.
+// Multi-layer mode: boxes connect on their own layer, and a via box on cut layer k connects to the boxes of layers k
+// and k + 1 that it touches, and to the touching vias of the same cut. Vias of different cuts only connect through
+// metal, even if they touch.
+//
+// Usage:
+//     auto compIds = ConnectedComponents(shapes, layers, vias, viaLayers);
+//
+
+#pragma once
+
+#include <map>
+#include <queue>
+
+#include "box_set.h"
+#include "geo.h"
+#include "parallel.h"
+#include "union_find.h"
+
+namespace utils {
+
+struct AlwaysConnect {
+    bool operator()(int, int) const { return true; }
+};
+
+// Union every touching/overlapping (closed intersection) pair (i, j) of boxes[items] with canConnect(i, j) in uf
+// (indexed as boxes)
+// Near-linear for layouts, including a few tall boxes (ActiveBoxSetT).
+template <typename T, typename CanConnect = AlwaysConnect>
+void UnionTouchingBoxes(const std::vector<BoxT<T>>& boxes,
+                        std::vector<int> items,
+                        UnionFind& uf,
+                        int numThreads = 0,
+                        const CanConnect& canConnect = CanConnect()) {
+    items.erase(std::remove_if(items.begin(), items.end(), [&](int i) { return !boxes[i].IsValid(); }), items.end());
+    if (items.size() <= 1) return;
+    ParallelSort(
+        items.begin(), items.end(), [&](int lhs, int rhs) { return boxes[lhs].lx() < boxes[rhs].lx(); }, numThreads);
+
+    size_t numStrips = std::min<size_t>(GetNumThreads(numThreads), (items.size() + 1023) / 1024);
+    ParallelFor(
+        0,
+        numStrips,
+        [&](size_t strip) {
+            size_t begin = items.size() * strip / numStrips, end = items.size() * (strip + 1) / numStrips;
+            ActiveBoxSetT<T> active(boxes);
+            auto cmpExpire = [&](int lhs, int rhs) { return boxes[lhs].hx() > boxes[rhs].hx(); };
+            std::priority_queue<int, std::vector<int>, decltype(cmpExpire)> toExpire(cmpExpire);
+            auto activate = [&](int i) {
+                active.Insert(i);
+                toExpire.push(i);
+            };
+            // earlier boxes still active at the strip start (their pairs among themselves are found by other strips)
+            for (size_t k = 0; k < begin; ++k) {
+                if (boxes[items[k]].hx() >= boxes[items[begin]].lx()) activate(items[k]);
+            }
+            for (size_t k = begin; k < end; ++k) {
+                int i = items[k];
+                const auto& box = boxes[i];
+                while (!toExpire.empty() && boxes[toExpire.top()].hx() < box.lx()) {
+                    active.Erase(toExpire.top());
+                    toExpire.pop();
+                }
+                active.ForEachInRange(box.ly(), box.hy(), [&](int j) {
+                    if (canConnect(i, j)) uf.Union(i, j);
+                });
+                activate(i);
+            }
+        },
+        static_cast<int>(numStrips),
+        1);
+}
+
+// Dense component id of every element (numbered in the order of their first elements)
+inline std::vector<int> GetComponentIds(UnionFind& uf) {
+    std::vector<int> rootIds(uf.size(), -1), ids(uf.size());
+    int numComponents = 0;
+    for (int i = 0; i < static_cast<int>(uf.size()); ++i) {
+        int& rootId = rootIds[uf.Find(i)];
+        if (rootId < 0) rootId = numComponents++;
+        ids[i] = rootId;
+    }
+    return ids;
+}
+
+// Component id of every box (invalid boxes are singletons)
+template <typename T>
+std::vector<int> ConnectedComponents(const std::vector<BoxT<T>>& boxes, int numThreads = 0) {
+    UnionFind uf(boxes.size());
+    std::vector<int> items(boxes.size());
+    for (int i = 0; i < static_cast<int>(items.size()); ++i) items[i] = i;
+    UnionTouchingBoxes(boxes, move(items), uf, numThreads);
+    return GetComponentIds(uf);
+}
+
+// Multi-layer components: boxes[i] is on layers[i], vias[k] is on the cut between viaLayers[k] and viaLayers[k] + 1
+// Return the component ids of the boxes followed by those of the vias.
+template <typename T>
+std::vector<int> ConnectedComponents(const std::vector<BoxT<T>>& boxes,
+                                     const std::vector<int>& layers,
+                                     const std::vector<BoxT<T>>& vias,
+                                     const std::vector<int>& viaLayers,
+                                     int numThreads = 0) {
+    // a via takes part in the sweeps of both layers it connects
+    std::vector<BoxT<T>> all = boxes;
+    all.insert(all.end(), vias.begin(), vias.end());
+    std::map<int, std::vector<int>> layerItems;
+    for (int i = 0; i < static_cast<int>(boxes.size()); ++i) layerItems[layers[i]].push_back(i);
+    for (int k = 0; k < static_cast<int>(vias.size()); ++k) {
+        layerItems[viaLayers[k]].push_back(boxes.size() + k);
+        layerItems[viaLayers[k] + 1].push_back(boxes.size() + k);
+    }
+    // vias of different cuts (below and above a layer) only connect through metal
+    int numBoxes = boxes.size();
+    auto canConnect = [&](int i, int j) {
+        return i < numBoxes || j < numBoxes || viaLayers[i - numBoxes] == viaLayers[j - numBoxes];
+    };
+    UnionFind uf(all.size());
+    for (auto& layer : layerItems) UnionTouchingBoxes(all, move(layer.second), uf, numThreads, canConnect);
+    return GetComponentIds(uf);
+}
+
+}  // namespace utils
@@ -0,0 +1,187 @@
+//
+// Containment forest of a box set (e.g., cell hierarchies, nested regions)
+// The parent of a box is the smallest box of the set containing it, for any overlaps between the boxes. Boxes are
+// swept by lx, containers before the boxes they contain, and the ones crossing the sweep line are kept in a treap by
+// ly whose nodes hold the max hy and the max hx of their subtrees. A query only descends into the subtrees with a
+// small enough ly and a large enough hy and hx, so it is O((d + 1) log n) per box in hierarchies of depth d (the
+// active boxes spanning a box in y are its ancestors), and degrades towards the size of the active set only when many
+// active boxes span a box in y and reach beyond it in x without containing it.
+//
+// Usage:
+//     auto parents = ContainmentForest(boxes);  // -1 for roots
+//
+
+#pragma once
+
+#include <cstdint>
+
+#include "geo.h"
+#include "parallel.h"
+
+namespace utils {
+
+// outer contains inner (closed), or contains it in its interior (every side strictly inside) if isStrict
+template <typename T>
+constexpr bool IsContainedIn(const BoxT<T>& inner, const BoxT<T>& outer, bool isStrict) noexcept {
+    if (isStrict) {
+        return outer.lx() < inner.lx() && outer.ly() < inner.ly() && inner.hx() < outer.hx() && inner.hy() < outer.hy();
+    }
+    return outer.lx() <= inner.lx() && outer.ly() <= inner.ly() && inner.hx() <= outer.hx() && inner.hy() <= outer.hy();
+}
+
+// Treap of the boxes crossing the sweep line of ContainmentForest(), by (ly, index)
+template <typename T>
+class ActiveBoxTreapT {
+public:
+    void Insert(const BoxT<T>& box, int idx) {
+        int id;
+        if (_freeIds.empty()) {
+            id = _nodes.size();
+            _nodes.emplace_back();
+        } else {
+            id = _freeIds.back();
+            _freeIds.pop_back();
+        }
+        // a mixed index as the priority keeps the result deterministic
+        uint32_t priority = static_cast<uint32_t>(idx) * 2654435761u;
+        priority ^= priority >> 16;
+        _nodes[id] = {box, box.area(), box.hy(), box.hx(), idx, priority, -1, -1};
+        int lhs, rhs;
+        Split(_root, box.ly(), idx, lhs, rhs);
+        _root = Merge(Merge(lhs, id), rhs);
+    }
+    void Erase(const BoxT<T>& box, int idx) { _root = Erase(_root, box.ly(), idx); }
+
+    // the smallest active box (by area, then by the larger index) containing box (see IsContainedIn), -1 if none
+    int FindSmallestContainer(const BoxT<T>& box, bool isStrict) {
+        auto isCandidate = [&](T hy, T hx) {
+            return isStrict ? hy > box.hy() && hx > box.hx() : hy >= box.hy() && hx >= box.hx();
+        };
+        int found = -1;
+        _stack.assign(1, _root);
+        while (!_stack.empty()) {
+            int id = _stack.back();
+            _stack.pop_back();
+            if (id < 0 || !isCandidate(_nodes[id].maxHy, _nodes[id].maxHx)) continue;
+            const Node& node = _nodes[id];
+            _stack.push_back(node.left);
+            if (isStrict ? node.box.ly() >= box.ly() : node.box.ly() > box.ly()) continue;
+            _stack.push_back(node.right);
+            if (IsContainedIn(box, node.box, isStrict) &&
+                (found < 0 || node.area < _nodes[found].area ||
+                 (node.area == _nodes[found].area && node.idx > _nodes[found].idx))) {
+                found = id;
+            }
+        }
+        return found < 0 ? -1 : _nodes[found].idx;
+    }
+
+private:
+    struct Node {
+        BoxT<T> box;
+        WideT<T> area;
+        T maxHy, maxHx;  // of the subtree
+        int idx;
+        uint32_t priority;
+        int left, right;
+    };
+    std::vector<Node> _nodes;
+    std::vector<int> _freeIds, _stack;
+    int _root = -1;
+
+    bool IsBefore(int id, T ly, int idx) const {
+        return _nodes[id].box.ly() < ly || (_nodes[id].box.ly() == ly && _nodes[id].idx < idx);
+    }
+    void Update(int id) {
+        Node& node = _nodes[id];
+        node.maxHy = node.box.hy();
+        node.maxHx = node.box.hx();
+        for (int child : {node.left, node.right}) {
+            if (child < 0) continue;
+            node.maxHy = std::max(node.maxHy, _nodes[child].maxHy);
+            node.maxHx = std::max(node.maxHx, _nodes[child].maxHx);
+        }
+    }
+    // lhs gets the nodes before (ly, idx), rhs the others
+    void Split(int id, T ly, int idx, int& lhs, int& rhs) {
+        if (id < 0) {
+            lhs = rhs = -1;
+        } else if (IsBefore(id, ly, idx)) {
+            Split(_nodes[id].right, ly, idx, _nodes[id].right, rhs);
+            lhs = id;
+            Update(id);
+        } else {
+            Split(_nodes[id].left, ly, idx, lhs, _nodes[id].left);
+            rhs = id;
+            Update(id);
+        }
+    }
+    int Merge(int lhs, int rhs) {
+        if (lhs < 0 || rhs < 0) return lhs < 0 ? rhs : lhs;
+        if (_nodes[lhs].priority > _nodes[rhs].priority) {
+            _nodes[lhs].right = Merge(_nodes[lhs].right, rhs);
+            Update(lhs);
+            return lhs;
+        }
+        _nodes[rhs].left = Merge(lhs, _nodes[rhs].left);
+        Update(rhs);
+        return rhs;
+    }
+    int Erase(int id, T ly, int idx) {
+        if (id < 0) return -1;
+        if (_nodes[id].idx == idx) {
+            _freeIds.push_back(id);
+            return Merge(_nodes[id].left, _nodes[id].right);
+        }
+        if (IsBefore(id, ly, idx)) {
+            _nodes[id].right = Erase(_nodes[id].right, ly, idx);
+        } else {
+            _nodes[id].left = Erase(_nodes[id].left, ly, idx);
+        }
+        Update(id);
+        return id;
+    }
+};
+
+// parents[i]: index of the smallest box (by area, then by the larger index) containing boxes[i] (see IsContainedIn),
+// -1 if none
+// Among identical boxes (non-strict), each one is the parent of the next one by index. Boxes with zero width or height
+// (and invalid ones) are skipped: their parents are -1 and they are never parents.
+template <typename T>
+std::vector<int> ContainmentForest(const std::vector<BoxT<T>>& boxes, bool isStrict = false, int numThreads = 0) {
+    std::vector<int> parents(boxes.size(), -1), order;
+    for (int i = 0; i < static_cast<int>(boxes.size()); ++i) {
+        if (boxes[i].IsStrictValid()) order.push_back(i);
+    }
+    // by lx, a container goes before the boxes it contains (smaller ly, then larger hx, then larger hy, then index)
+    ParallelSort(
+        order.begin(),
+        order.end(),
+        [&](int lhs, int rhs) {
+            const auto &l = boxes[lhs], &r = boxes[rhs];
+            if (l.lx() != r.lx()) return l.lx() < r.lx();
+            if (l.ly() != r.ly()) return l.ly() < r.ly();
+            if (l.hx() != r.hx()) return l.hx() > r.hx();
+            if (l.hy() != r.hy()) return l.hy() > r.hy();
+            return lhs < rhs;
+        },
+        numThreads);
+    std::vector<int> byHx = order;
+    ParallelSort(
+        byHx.begin(), byHx.end(), [&](int lhs, int rhs) { return boxes[lhs].hx() < boxes[rhs].hx(); }, numThreads);
+
+    ActiveBoxTreapT<T> actives;
+    size_t numRemoved = 0;
+    for (int i : order) {
+        const auto& box = boxes[i];
+        // boxes ending at or before lx cannot contain box (they could only touch it)
+        for (; numRemoved < byHx.size() && boxes[byHx[numRemoved]].hx() <= box.lx(); ++numRemoved) {
+            actives.Erase(boxes[byHx[numRemoved]], byHx[numRemoved]);
+        }
+        parents[i] = actives.FindSmallestContainer(box, isStrict);
+        actives.Insert(box, i);
+    }
+    return parents;
+}
+
+}  // namespace utils
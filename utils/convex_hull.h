@@ -0,0 +1,143 @@
+//
+// Convex hull of a point set and rotating calipers on it
+// 1. ConvexHull: Andrew's monotone chain (parallel presort for large inputs)
+// 2. HullDiameter/HullWidth: farthest pair and minimum width
+// 3. MinAreaRect: minimum-area oriented bounding rectangle
+// All decisions use the exact orientation predicates of geo.h (Cross/Dot in the wide type), so integer inputs are
+// handled without robustness issues; only the reported lengths/corners are computed in double.
+//
+
+#pragma once
+
+#include <array>
+
+#include "geo.h"
+#include "parallel.h"
+
+namespace utils {
+
+// Convex hull in counter-clockwise order from the lowest-x (then lowest-y) point, without collinear points
+template <typename T>
+std::vector<PointT<T>> ConvexHull(std::vector<PointT<T>> pts, int numThreads = 0) {
+    ParallelSort(
+        pts.begin(),
+        pts.end(),
+        [](const PointT<T>& lhs, const PointT<T>& rhs) { return lhs.x < rhs.x || (lhs.x == rhs.x && lhs.y < rhs.y); },
+        numThreads);
+    pts.erase(std::unique(pts.begin(), pts.end()), pts.end());
+    if (pts.size() <= 2) return pts;
+
+    // lower chain left to right, then upper chain right to left
+    std::vector<PointT<T>> hull(2 * pts.size());
+    size_t k = 0;
+    for (size_t i = 0; i < pts.size(); ++i) {
+        while (k >= 2 && Cross(hull[k - 2], hull[k - 1], pts[i]) <= 0) --k;
+        hull[k++] = pts[i];
+    }
+    for (size_t i = pts.size() - 1, lowerSize = k + 1; i-- > 0;) {
+        while (k >= lowerSize && Cross(hull[k - 2], hull[k - 1], pts[i]) <= 0) --k;
+        hull[k++] = pts[i];
+    }
+    hull.resize(k - 1);  // the last point is the first one
+    return hull;
+}
+
+// Farthest pair of hull vertices (indices into hull), by rotating calipers in O(h)
+template <typename T>
+std::pair<int, int> HullDiameter(const std::vector<PointT<T>>& hull) {
+    int n = hull.size();
+    if (n <= 2) return {0, std::max(n - 1, 0)};
+    std::pair<int, int> best = {0, 0};
+    WideT<T> bestDist = 0;
+    auto update = [&](int i, int j) {
+        WideT<T> dist = SquaredL2Dist(hull[i], hull[j]);
+        if (dist > bestDist) {
+            bestDist = dist;
+            best = {std::min(i, j), std::max(i, j)};
+        }
+    };
+    for (int i = 0, j = 1; i < n; ++i) {
+        int i2 = (i + 1) % n;
+        // the farthest vertex from the line of edge (i, i2), or two if an edge there is parallel to it
+        while (Cross(hull[i], hull[i2], hull[(j + 1) % n]) > Cross(hull[i], hull[i2], hull[j])) j = (j + 1) % n;
+        update(i, j);
+        update(i2, j);
+        if (Cross(hull[i], hull[i2], hull[(j + 1) % n]) == Cross(hull[i], hull[i2], hull[j])) {
+            update(i, (j + 1) % n);
+            update(i2, (j + 1) % n);
+        }
+    }
+    return best;
+}
+
+// Minimum width of the hull (the smallest distance between two parallel supporting lines)
+template <typename T>
+double HullWidth(const std::vector<PointT<T>>& hull) {
+    int n = hull.size();
+    if (n <= 2) return 0;
+    double width = std::numeric_limits<double>::max();
+    for (int i = 0, j = 1; i < n; ++i) {
+        int i2 = (i + 1) % n;
+        while (Cross(hull[i], hull[i2], hull[(j + 1) % n]) > Cross(hull[i], hull[i2], hull[j])) j = (j + 1) % n;
+        double len = std::sqrt(static_cast<double>(SquaredL2Dist(hull[i], hull[i2])));
+        width = std::min(width, static_cast<double>(Cross(hull[i], hull[i2], hull[j])) / len);
+    }
+    return width;
+}
+
+// Oriented rectangle by its corners in counter-clockwise order
+struct OrientedRect {
+    std::array<PointT<double>, 4> corners;
+    double width = 0;   // length of corners[0] -> corners[1]
+    double height = 0;  // length of corners[1] -> corners[2]
+    double area() const { return width * height; }
+};
+
+// Minimum-area rectangle enclosing the hull
+// One side of the optimum is collinear with a hull edge; for each edge, the extreme vertices along the edge, against
+// it and away from it are tracked by three calipers, O(h) in total.
+template <typename T>
+OrientedRect MinAreaRect(const std::vector<PointT<T>>& hull) {
+    OrientedRect rect;
+    int n = hull.size();
+    if (n == 0) return rect;
+    if (n == 1) {
+        rect.corners.fill(PointT<double>(hull[0].x, hull[0].y));
+        return rect;
+    }
+    auto next = [n](int i) { return i + 1 == n ? 0 : i + 1; };
+    double bestArea = std::numeric_limits<double>::max();
+    int top = 0, right = 0, left = 0;
+    for (int i = 0; i < n; ++i) {
+        const auto& o = hull[i];
+        const auto& a = hull[next(i)];
+        if (i == 0) {
+            for (int k = 0; k < n; ++k) {
+                if (Cross(o, a, hull[k]) > Cross(o, a, hull[top])) top = k;
+                if (Dot(o, a, hull[k]) > Dot(o, a, hull[right])) right = k;
+                if (Dot(o, a, hull[k]) < Dot(o, a, hull[left])) left = k;
+            }
+        } else {
+            while (Cross(o, a, hull[next(top)]) > Cross(o, a, hull[top])) top = next(top);
+            while (Dot(o, a, hull[next(right)]) > Dot(o, a, hull[right])) right = next(right);
+            while (Dot(o, a, hull[next(left)]) < Dot(o, a, hull[left])) left = next(left);
+        }
+        // in units of the edge vector d and its left normal (same length)
+        double len2 = static_cast<double>(SquaredL2Dist(o, a));
+        double lo = static_cast<double>(Dot(o, a, hull[left])) / len2;
+        double hi = static_cast<double>(Dot(o, a, hull[right])) / len2;
+        double h = static_cast<double>(Cross(o, a, hull[top])) / len2;
+        double area = (hi - lo) * h * len2;
+        if (area >= bestArea) continue;
+        bestArea = area;
+        double dx = static_cast<double>(a.x) - o.x, dy = static_cast<double>(a.y) - o.y;
+        auto corner = [&](double s, double t) { return PointT<double>(o.x + s * dx - t * dy, o.y + s * dy + t * dx); };
+        rect.corners = {corner(lo, 0), corner(hi, 0), corner(hi, h), corner(lo, h)};
+        double len = std::sqrt(len2);
+        rect.width = (hi - lo) * len;
+        rect.height = h * len;
+    }
+    return rect;
+}
+
+}  // namespace utils
@@ -0,0 +1,263 @@
+//
+// Free space (whitespace) among axis-parallel obstacles
+// 1. MaximalEmptyRects: exact enumeration of all maximal empty rectangles in a region
+// 2. FreeSpaceFinderT::FindFreeBox: largest free box of at least W x H near a point
+//
+
+#pragma once
+
+#include "box_index.h"
+
+namespace utils {
+
+template <typename T>
+struct FreeBoxResult {
+    BoxT<T> freeBox;    // maximal empty rectangle (invalid if not found)
+    BoxT<T> placement;  // W x H box in freeBox nearest to the query point
+};
+
+template <typename T>
+class FreeSpaceFinderT {
+public:
+    // obstacles are clipped to region, degenerated ones are ignored
+    FreeSpaceFinderT(const BoxT<T>& region, const std::vector<BoxT<T>>& obstacles) : _region(region) {
+        std::vector<BoxT<T>> clipped;
+        for (const auto& obstacle : obstacles) {
+            auto box = obstacle.IntersectWith(region);
+            if (box.IsStrictValid()) clipped.push_back(box);
+        }
+        _index.Build(clipped);
+        // twice the average obstacle height (positive, as the kept obstacles are), or the region height without any;
+        // zero only for a degenerated region, which has no free box
+        double sumHeight = 0;
+        for (const auto& box : clipped) sumHeight += box.height();
+        _bandHeight = clipped.empty() ? std::max<T>(region.height(), 0)
+                                      : static_cast<T>(sumHeight / clipped.size() * 2);
+    }
+
+    // func(rect) on every maximal empty rectangle (with positive area) in the region
+    // Staircase sweep: for each bottom support (the region bottom or obstacle tops at the same y), intervals of free
+    // space are swept upwards through the obstacles above them (fetched band by band from the index) and split at
+    // each obstacle, where the rectangle below is emitted.
+    template <typename Func>
+    void ForEachMaximalEmptyRect(const Func& func) const {
+        if (!_region.IsStrictValid()) return;
+        const auto& obstacles = _index.boxes();
+        std::vector<int> byTop(obstacles.size());
+        for (int i = 0; i < static_cast<int>(byTop.size()); ++i) byTop[i] = i;
+        std::sort(byTop.begin(), byTop.end(), [&](int lhs, int rhs) {
+            return obstacles[lhs].hy() < obstacles[rhs].hy() ||
+                   (obstacles[lhs].hy() == obstacles[rhs].hy() && obstacles[lhs].lx() < obstacles[rhs].lx());
+        });
+        std::vector<IntervalT<T>> supports = {_region.x};
+        ScanUp(_region.ly(), supports, func);
+        for (size_t i = 0; i < byTop.size();) {
+            T bottom = obstacles[byTop[i]].hy();
+            supports.clear();
+            for (; i < byTop.size() && obstacles[byTop[i]].hy() == bottom; ++i) {
+                supports.push_back(obstacles[byTop[i]].x);
+            }
+            if (bottom < _region.hy()) ScanUp(bottom, supports, func);
+        }
+    }
+    std::vector<BoxT<T>> MaximalEmptyRects() const {
+        std::vector<BoxT<T>> rects;
+        ForEachMaximalEmptyRect([&](const BoxT<T>& rect) { rects.push_back(rect); });
+        return rects;
+    }
+
+    // Largest free box of at least width x height near pt
+    // pt is the desired lower-left corner, the distance is L-1 from pt to the nearest feasible corner. Maximal empty
+    // rectangles are enumerated in a window around pt that grows until it is guaranteed to contain the optimum, and
+    // the winner is then grown to a globally maximal one. Among equally near boxes, the larger one is preferred.
+    FreeBoxResult<T> FindFreeBox(const PointT<T>& pt, T width, T height) const {
+        FreeBoxResult<T> result;
+        if (!_region.IsStrictValid()) return result;  // no free box with positive area (and _bandHeight is 0)
+        T margin = std::max(std::max(width, height), _bandHeight);
+        for (T radius = margin;; radius = radius * 2) {
+            BoxT<T> window(pt.x - radius, pt.y - radius, pt.x + radius, pt.y + radius);
+            window = window.IntersectWith(_region);
+            bool isWholeRegion = window == _region;
+            T bestDist = std::numeric_limits<T>::max();
+            if (window.IsStrictValid()) {
+                std::vector<BoxT<T>> localObstacles;
+                _index.Query(window, [&](int i) { localObstacles.push_back(_index.boxes()[i]); });
+                FreeSpaceFinderT<T> local(window, localObstacles);
+                local.ForEachMaximalEmptyRect([&](const BoxT<T>& rect) {
+                    if (rect.width() < width || rect.height() < height) return;
+                    BoxT<T> corners(rect.lx(), rect.ly(), rect.hx() - width, rect.hy() - height);
+                    T dist = Dist(corners, pt);
+                    if (dist < bestDist || (dist == bestDist && rect.area() > result.freeBox.area())) {
+                        bestDist = dist;
+                        result.freeBox = rect;
+                        PointT<T> corner = corners.GetNearestPointTo(pt);
+                        result.placement.Set(corner.x, corner.y, corner.x + width, corner.y + height);
+                    }
+                });
+            }
+            bool isFound = result.freeBox.IsValid();
+            if (isWholeRegion || (isFound && radius >= bestDist + std::max(width, height))) break;
+            result.freeBox.Set();
+            result.placement.Set();
+        }
+        if (result.freeBox.IsValid()) GrowEmptyBox(result.freeBox);
+        return result;
+    }
+
+    const BoxT<T>& region() const { return _region; }
+
+private:
+    BoxT<T> _region;
+    BoxGridIndexT<T> _index;
+    T _bandHeight;  // initial band height of the upward scans
+
+    bool IsSupported(const std::vector<IntervalT<T>>& supports, const std::vector<T>& maxHighs, T lo, T hi) const {
+        auto it = std::lower_bound(
+            supports.begin(), supports.end(), hi, [](const IntervalT<T>& support, T val) { return support.low < val; });
+        return it != supports.begin() && maxHighs[it - supports.begin() - 1] > lo;
+    }
+
+    // append the supported pieces of intvl minus blocked (sorted and disjoint, from index k on) to pieces
+    void AppendFreePieces(const IntervalT<T>& intvl,
+                          const std::vector<IntervalT<T>>& blocked,
+                          size_t k,
+                          const std::vector<IntervalT<T>>& supports,
+                          const std::vector<T>& maxHighs,
+                          std::vector<IntervalT<T>>& pieces) const {
+        T lo = intvl.low;
+        for (; k < blocked.size() && blocked[k].low < intvl.high; ++k) {
+            if (blocked[k].low > lo && IsSupported(supports, maxHighs, lo, blocked[k].low)) {
+                pieces.emplace_back(lo, blocked[k].low);
+            }
+            lo = std::max(lo, blocked[k].high);
+        }
+        if (lo < intvl.high && IsSupported(supports, maxHighs, lo, intvl.high)) pieces.emplace_back(lo, intvl.high);
+    }
+
+    // sorted obstacle indices -> merged x ranges
+    void MergeXRanges(const std::vector<int>& idxs, size_t begin, size_t end, std::vector<IntervalT<T>>& ranges) const {
+        ranges.clear();
+        for (size_t i = begin; i < end; ++i) {
+            const auto& x = _index.boxes()[idxs[i]].x;
+            if (!ranges.empty() && x.low <= ranges.back().high) {
+                ranges.back().high = std::max(ranges.back().high, x.high);
+            } else {
+                ranges.push_back(x);
+            }
+        }
+    }
+
+    // emit maximal empty rectangles with bottom y = bottom and bottom edge on supports (sorted by low)
+    template <typename Func>
+    void ScanUp(T bottom, const std::vector<IntervalT<T>>& supports, const Func& func) const {
+        std::vector<T> maxHighs(supports.size());
+        for (size_t i = 0; i < supports.size(); ++i) {
+            maxHighs[i] = i == 0 ? supports[i].high : std::max(maxHighs[i - 1], supports[i].high);
+        }
+        const auto& obstacles = _index.boxes();
+        auto byLowX = [&](int lhs, int rhs) { return obstacles[lhs].lx() < obstacles[rhs].lx(); };
+        std::vector<IntervalT<T>> live, nextLive, blocked;
+        std::vector<int> candidates;
+
+        // 1. free intervals right above bottom around the supports, bounded by the obstacles crossing bottom
+        // (the window grows until no interval is cut by its boundary)
+        for (T step = _bandHeight;; step = step * 2) {
+            T lo = supports.front().low, hi = maxHighs.back();
+            lo = lo - _region.lx() <= step ? _region.lx() : lo - step;
+            hi = _region.hx() - hi <= step ? _region.hx() : hi + step;
+            candidates.clear();
+            _index.Query(BoxT<T>(lo, bottom, hi, bottom), [&](int i) {
+                if (obstacles[i].hy() > bottom) candidates.push_back(i);
+            });
+            std::sort(candidates.begin(), candidates.end(), byLowX);
+            MergeXRanges(candidates, 0, candidates.size(), blocked);
+            live.clear();
+            AppendFreePieces({lo, hi}, blocked, 0, supports, maxHighs, live);
+            if (live.empty() || ((live.front().low > lo || lo == _region.lx()) &&
+                                 (live.back().high < hi || hi == _region.hx()))) {
+                break;
+            }
+        }
+
+        // 2. sweep upwards band by band
+        T bandLow = bottom, bandHigh = bottom + std::min(_bandHeight, _region.hy() - bottom);
+        while (!live.empty()) {
+            // obstacles starting in (bandLow, bandHigh], sorted by ly
+            candidates.clear();
+            _index.Query(BoxT<T>(live.front().low, bandLow, live.back().high, bandHigh), [&](int i) {
+                if (obstacles[i].ly() > bandLow) candidates.push_back(i);
+            });
+            std::sort(candidates.begin(), candidates.end(), [&](int lhs, int rhs) {
+                return obstacles[lhs].ly() < obstacles[rhs].ly() ||
+                       (obstacles[lhs].ly() == obstacles[rhs].ly() && obstacles[lhs].lx() < obstacles[rhs].lx());
+            });
+
+            for (size_t i = 0; i < candidates.size() && !live.empty();) {
+                // merged x ranges of the obstacles starting at the same y
+                T y = obstacles[candidates[i]].ly();
+                size_t end = i;
+                while (end < candidates.size() && obstacles[candidates[end]].ly() == y) ++end;
+                MergeXRanges(candidates, i, end, blocked);
+                i = end;
+                // emit and split the live intervals hit by them
+                nextLive.clear();
+                size_t k = 0;
+                for (const auto& intvl : live) {
+                    while (k < blocked.size() && blocked[k].high <= intvl.low) ++k;
+                    if (k == blocked.size() || blocked[k].low >= intvl.high) {
+                        nextLive.push_back(intvl);
+                        continue;
+                    }
+                    func(BoxT<T>(intvl.low, bottom, intvl.high, y));
+                    AppendFreePieces(intvl, blocked, k, supports, maxHighs, nextLive);
+                }
+                live.swap(nextLive);
+            }
+
+            if (bandHigh >= _region.hy()) {
+                for (const auto& intvl : live) func(BoxT<T>(intvl.low, bottom, intvl.high, _region.hy()));
+                break;
+            }
+            T step = bandHigh - bottom;
+            bandLow = bandHigh;
+            bandHigh = _region.hy() - bandHigh <= step ? _region.hy() : bandHigh + step;
+        }
+    }
+
+    // grow an empty box to a maximal one (left, right, down, then up)
+    void GrowEmptyBox(BoxT<T>& box) const {
+        for (int dir = 0; dir < 2; ++dir) {
+            for (int side = 0; side < 2; ++side) {
+                T limit = side == 0 ? _region[dir].low : _region[dir].high;
+                for (T step = _bandHeight;; step = step * 2) {
+                    BoxT<T> window = box;
+                    if (side == 0) {
+                        window[dir].Set(std::max(limit, box[dir].low - step), box[dir].low);
+                    } else {
+                        window[dir].Set(box[dir].high, std::min(limit, box[dir].high + step));
+                    }
+                    T bound = side == 0 ? window[dir].low : window[dir].high;
+                    bool isBlocked = false;
+                    _index.Query(window, [&](int i) {
+                        const auto& obstacle = _index.boxes()[i];
+                        if (!obstacle[1 - dir].HasStrictIntersectWith(box[1 - dir])) return;
+                        isBlocked = true;
+                        bound = side == 0 ? std::max(bound, obstacle[dir].high) : std::min(bound, obstacle[dir].low);
+                    });
+                    if (isBlocked || bound == limit) {
+                        (side == 0 ? box[dir].low : box[dir].high) = bound;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+};
+
+// All maximal empty rectangles among obstacles in region
+template <typename T>
+std::vector<BoxT<T>> MaximalEmptyRects(const BoxT<T>& region, const std::vector<BoxT<T>>& obstacles) {
+    return FreeSpaceFinderT<T>(region, obstacles).MaximalEmptyRects();
+}
+
+}  // namespace utils
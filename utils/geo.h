@@ -4,44 +4,91 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <iostream>
 #include <limits>
+#include <type_traits>
+#include <vector>
 
 namespace utils {
 
+// Wide type for exact products/sums of coordinates (areas, half perimeters, squared distances, cross products)
+// 8/16/32-bit integers -> 64-bit, 64-bit integers -> 128-bit (double if the compiler has no __int128), floating
+// points -> double. Products are exact as long as the factors fit in half of the wide type (e.g., box widths < 2^31).
+// The wide type is signed also for unsigned coordinates, so that differences (e.g., in cross products) do not wrap.
+template <typename T, typename Enable = void>
+struct WideType {
+    using type = double;
+};
+template <typename T>
+struct WideType<T, typename std::enable_if<std::is_integral<T>::value && (sizeof(T) < 8)>::type> {
+    using type = long long;
+};
+template <typename T>
+struct WideType<T, typename std::enable_if<std::is_integral<T>::value && sizeof(T) == 8>::type> {
+#if defined(__SIZEOF_INT128__)
+    __extension__ using type = __int128;
+#else
+    using type = double;
+#endif
+};
+template <>
+struct WideType<long double> {
+    using type = long double;
+};
+template <typename T>
+using WideT = typename WideType<T>::type;
+
+// Invalid coordinate value (infinity if any, the maximum otherwise), the low end of an empty interval
+template <typename T>
+constexpr T InfCoord() noexcept {
+    return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max();
+}
+// The high end of an empty interval
+template <typename T>
+constexpr T NegInfCoord() noexcept {
+    return std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity()
+                                                : std::numeric_limits<T>::lowest();
+}
+
+// |val| (std::abs is not constexpr)
+template <typename T>
+constexpr T AbsCoord(T val) noexcept {
+    return val < 0 ? -val : val;
+}
+
 // Point template
+// All primitives are trivially copyable literal types, so they can be memcpy-ed, mmap-ed and built in constant
+// expressions (e.g., constexpr lookup tables).
 template <typename T>
 class PointT {
 public:
     T x, y;
-    PointT(T xx = std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity()
-                                                                 : std::numeric_limits<T>::max(),
-                     T yy = std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity()
-                                                                 : std::numeric_limits<T>::max())
-        : x(xx), y(yy) {}
-    bool IsValid() { return *this != PointT(); }
+    constexpr PointT() noexcept : x(InfCoord<T>()), y(InfCoord<T>()) {}
+    constexpr explicit PointT(T xx) noexcept : x(xx), y(InfCoord<T>()) {}
+    constexpr PointT(T xx, T yy) noexcept : x(xx), y(yy) {}
+    constexpr bool IsValid() const noexcept { return *this != PointT(); }
 
     // Operators
-    T& operator[](unsigned d) {
-        assert(d == 0 || d == 1);
-        return (d == 0 ? x : y);
-    }
-    PointT operator+(const PointT& rhs) { return PointT(x + rhs.x, y + rhs.y); }
-    PointT operator/(T divisor) { return PointT(x / divisor, y / divisor); }
-    PointT& operator+=(const PointT& rhs) {
+    // d is 0 (x) or 1 (y), unchecked
+    constexpr T& operator[](unsigned d) noexcept { return d == 0 ? x : y; }
+    constexpr const T& operator[](unsigned d) const noexcept { return d == 0 ? x : y; }
+    constexpr PointT operator+(const PointT& rhs) const noexcept { return PointT(x + rhs.x, y + rhs.y); }
+    constexpr PointT operator/(T divisor) const noexcept { return PointT(x / divisor, y / divisor); }
+    constexpr PointT& operator+=(const PointT& rhs) noexcept {
         x += rhs.x;
         y += rhs.y;
         return *this;
     }
-    PointT& operator-=(const PointT& rhs) {
+    constexpr PointT& operator-=(const PointT& rhs) noexcept {
         x -= rhs.x;
         y -= rhs.y;
         return *this;
     }
-    bool operator==(const PointT& rhs) const { return x == rhs.x && y == rhs.y; }
-    bool operator!=(const PointT& rhs) const { return !(*this == rhs); }
+    constexpr bool operator==(const PointT& rhs) const noexcept { return x == rhs.x && y == rhs.y; }
+    constexpr bool operator!=(const PointT& rhs) const noexcept { return !(*this == rhs); }
 
     friend inline std::ostream& operator<<(std::ostream& os, const PointT& pt) {
         os << "(" << pt.x << ", " << pt.y << ")";
@@ -51,20 +98,83 @@ public:
 
 // L-1 (Manhattan) distance between points
 template <typename T>
-inline T Dist(const PointT<T>& pt1, const PointT<T>& pt2) {
-    return std::abs(pt1.x - pt2.x) + std::abs(pt1.y - pt2.y);
+constexpr T Dist(const PointT<T>& pt1, const PointT<T>& pt2) noexcept {
+    return AbsCoord(pt1.x - pt2.x) + AbsCoord(pt1.y - pt2.y);
+}
+
+// Squared L-2 distance between points (exact for integers)
+template <typename T>
+constexpr WideT<T> SquaredL2Dist(const PointT<T>& pt1, const PointT<T>& pt2) noexcept {
+    WideT<T> dx = WideT<T>(pt1.x) - pt2.x, dy = WideT<T>(pt1.y) - pt2.y;
+    return dx * dx + dy * dy;
 }
 
 // L-2 (Euclidean) distance between points
 template <typename T>
 inline double L2Dist(const PointT<T>& pt1, const PointT<T>& pt2) {
-    return std::sqrt(std::pow(pt1.x - pt2.x, 2) + std::pow(pt1.y - pt2.y, 2));
+    return std::sqrt(static_cast<double>(SquaredL2Dist(pt1, pt2)));
 }
 
 // L-inf distance between points
 template <typename T>
-inline T LInfDist(const PointT<T>& pt1, const PointT<T>& pt2) {
-    return std::max(std::abs(pt1.x - pt2.x), std::abs(pt1.y - pt2.y));
+constexpr T LInfDist(const PointT<T>& pt1, const PointT<T>& pt2) noexcept {
+    return std::max(AbsCoord(pt1.x - pt2.x), AbsCoord(pt1.y - pt2.y));
+}
+
+// Distance metrics for neighborhood/batch queries
+enum class DistMetric { L1, L2, LInf };
+
+// Whether two points are within dist under metric (L-2 is compared in squared form, no sqrt)
+template <typename T>
+constexpr bool IsWithinDist(const PointT<T>& pt1, const PointT<T>& pt2, T dist, DistMetric metric) noexcept {
+    switch (metric) {
+        case DistMetric::L1:
+            return Dist(pt1, pt2) <= dist;
+        case DistMetric::LInf:
+            return LInfDist(pt1, pt2) <= dist;
+        default:
+            return SquaredL2Dist(pt1, pt2) <= WideT<T>(dist) * dist;
+    }
+}
+
+// Cross product of (a - o) and (b - o), positive if o -> a -> b turns counter-clockwise
+// Exact for integer coordinates whose differences fit in half of the wide type (e.g., |coordinate| < 2^30 for int).
+template <typename T>
+constexpr WideT<T> Cross(const PointT<T>& o, const PointT<T>& a, const PointT<T>& b) noexcept {
+    return (WideT<T>(a.x) - o.x) * (WideT<T>(b.y) - o.y) - (WideT<T>(a.y) - o.y) * (WideT<T>(b.x) - o.x);
+}
+
+// Dot product of (a - o) and (b - o)
+template <typename T>
+constexpr WideT<T> Dot(const PointT<T>& o, const PointT<T>& a, const PointT<T>& b) noexcept {
+    return (WideT<T>(a.x) - o.x) * (WideT<T>(b.x) - o.x) + (WideT<T>(a.y) - o.y) * (WideT<T>(b.y) - o.y);
+}
+
+// Orientation of o -> a -> b: 1 for counter-clockwise, -1 for clockwise, 0 for collinear
+template <typename T>
+constexpr int Orientation(const PointT<T>& o, const PointT<T>& a, const PointT<T>& b) noexcept {
+    WideT<T> cross = Cross(o, a, b);
+    return cross > 0 ? 1 : (cross < 0 ? -1 : 0);
+}
+
+// Whether pt lies on the closed segment [a, b]
+template <typename T>
+constexpr bool IsOnSegment(const PointT<T>& pt, const PointT<T>& a, const PointT<T>& b) noexcept {
+    return Cross(a, b, pt) == 0 && std::min(a.x, b.x) <= pt.x && pt.x <= std::max(a.x, b.x) &&
+           std::min(a.y, b.y) <= pt.y && pt.y <= std::max(a.y, b.y);
+}
+
+// Whether closed segments [a1, a2] and [b1, b2] intersect (including touching and collinear overlap)
+template <typename T>
+constexpr bool IsSegmentIntersect(const PointT<T>& a1,
+                                  const PointT<T>& a2,
+                                  const PointT<T>& b1,
+                                  const PointT<T>& b2) noexcept {
+    int o1 = Orientation(a1, a2, b1), o2 = Orientation(a1, a2, b2);
+    int o3 = Orientation(b1, b2, a1), o4 = Orientation(b1, b2, a2);
+    if (o1 != o2 && o3 != o4) return true;
+    return (o1 == 0 && IsOnSegment(b1, a1, a2)) || (o2 == 0 && IsOnSegment(b2, a1, a2)) ||
+           (o3 == 0 && IsOnSegment(a1, b1, b2)) || (o4 == 0 && IsOnSegment(a2, b1, b2));
 }
 
 // Interval template
@@ -73,37 +183,36 @@ class IntervalT {
 public:
     T low, high;
 
-    template <typename... Args>
-    IntervalT(Args... params) {
-        Set(params...);
-    }
+    // empty (invalid) interval by default
+    constexpr IntervalT() noexcept : low(InfCoord<T>()), high(NegInfCoord<T>()) {}
+    constexpr explicit IntervalT(T val) noexcept : low(val), high(val) {}
+    constexpr IntervalT(T lo, T hi) noexcept : low(lo), high(hi) {}
 
     // Setters
-    void Set() {
-        low = std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max();
-        high = std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity()
-                                                    : std::numeric_limits<T>::lowest();
+    constexpr void Set() noexcept {
+        low = InfCoord<T>();
+        high = NegInfCoord<T>();
     }
-    void Set(T val) {
+    constexpr void Set(T val) noexcept {
         low = val;
         high = val;
     }
-    void Set(T lo, T hi) {
+    constexpr void Set(T lo, T hi) noexcept {
         low = lo;
         high = hi;
     }
 
     // Getters
-    T center() const { return (high + low) / 2; }
-    T range() const { return high - low; }
+    constexpr T center() const noexcept { return (high + low) / 2; }
+    constexpr T range() const noexcept { return high - low; }
 
     // Update
     // Update() is always safe, FastUpdate() assumes existing values
-    void Update(T newVal) {
+    constexpr void Update(T newVal) noexcept {
         if (newVal < low) low = newVal;
         if (newVal > high) high = newVal;
     }
-    void FastUpdate(T newVal) {
+    constexpr void FastUpdate(T newVal) noexcept {
         if (newVal < low)
             low = newVal;
         else if (newVal > high)
@@ -112,13 +221,13 @@ public:
 
     // Two types of intervals: 1. normal, 2. degenerated (i.e., point)
     // is valid interval (i.e., valid closed interval)
-    bool IsValid() const { return low <= high; }
+    constexpr bool IsValid() const noexcept { return low <= high; }
     // is strictly valid interval (excluding degenerated ones, i.e., valid open interval)
-    bool IsStrictValid() const { return low < high; }
+    constexpr bool IsStrictValid() const noexcept { return low < high; }
 
     // Geometric Query/Update
     // interval/range of union (not union of intervals)
-    IntervalT UnionWith(const IntervalT& rhs) const {
+    constexpr IntervalT UnionWith(const IntervalT& rhs) const noexcept {
         if (!IsValid())
             return rhs;
         else if (!rhs.IsValid())
@@ -127,17 +236,19 @@ public:
             return IntervalT(std::min(low, rhs.low), std::max(high, rhs.high));
     }
     // may return an invalid interval (as empty intersection)
-    IntervalT IntersectWith(const IntervalT& rhs) const {
+    constexpr IntervalT IntersectWith(const IntervalT& rhs) const noexcept {
         return IntervalT(std::max(low, rhs.low), std::min(high, rhs.high));
     }
-    bool HasIntersectWith(const IntervalT& rhs) const { return IntersectWith(rhs).IsValid(); }
-    bool HasStrictIntersectWith(const IntervalT& rhs) const { return IntersectWith(rhs).IsStrictValid(); }
+    constexpr bool HasIntersectWith(const IntervalT& rhs) const noexcept { return IntersectWith(rhs).IsValid(); }
+    constexpr bool HasStrictIntersectWith(const IntervalT& rhs) const noexcept {
+        return IntersectWith(rhs).IsStrictValid();
+    }
 
-    bool Contain(int val) const { return val >= low && val <= high; }
-    bool StrictlyContain(int val) const { return val > low && val < high; }
+    constexpr bool Contain(T val) const noexcept { return val >= low && val <= high; }
+    constexpr bool StrictlyContain(T val) const noexcept { return val > low && val < high; }
 
     // get nearest point to val (assume valid intervals)
-    T GetNearestPointTo(T val) const {
+    constexpr T GetNearestPointTo(T val) const noexcept {
         if (val <= low) {
             return low;
         } else if (val >= high) {
@@ -146,26 +257,26 @@ public:
             return val;
         }
     }
-    IntervalT GetNearestPointsTo(IntervalT val) const {
+    constexpr IntervalT GetNearestPointsTo(IntervalT val) const noexcept {
         if (val.high <= low) {
-            return {low};
+            return IntervalT(low);
         } else if (val.low >= high) {
-            return {high};
+            return IntervalT(high);
         } else {
             return IntersectWith(val);
         }
     }
 
-    void ShiftBy(const T& rhs) {
+    constexpr void ShiftBy(const T& rhs) noexcept {
         low += rhs;
         high += rhs;
     }
 
     // Operators
-    bool operator==(const IntervalT& rhs) const {
+    constexpr bool operator==(const IntervalT& rhs) const noexcept {
         return (!IsValid() && !rhs.IsValid()) || (low == rhs.low && high == rhs.high);
     }
-    bool operator!=(const IntervalT& rhs) const { return !(*this == rhs); }
+    constexpr bool operator!=(const IntervalT& rhs) const noexcept { return !(*this == rhs); }
 
     friend inline std::ostream& operator<<(std::ostream& os, const IntervalT<T>& interval) {
         os << "(" << interval.low << ", " << interval.high << ")";
@@ -175,12 +286,12 @@ public:
 
 // Distance between intervals/points (assume valid intervals)
 template <typename T>
-inline T Dist(const IntervalT<T>& intvl, const T val) {
-    return std::abs(intvl.GetNearestPointTo(val) - val);
+constexpr T Dist(const IntervalT<T>& intvl, const T val) noexcept {
+    return AbsCoord(intvl.GetNearestPointTo(val) - val);
 }
 
 template <typename T>
-inline T Dist(const IntervalT<T>& int1, const IntervalT<T>& int2) {
+constexpr T Dist(const IntervalT<T>& int1, const IntervalT<T>& int2) noexcept {
     if (int1.high <= int2.low) {
         return int2.low - int1.high;
     } else if (int1.low >= int2.high) {
@@ -196,90 +307,95 @@ class BoxT {
 public:
     IntervalT<T> x, y;
 
-    template <typename... Args>
-    BoxT(Args... params) {
-        Set(params...);
-    }
+    // empty (invalid) box by default
+    constexpr BoxT() noexcept = default;
+    constexpr BoxT(T xVal, T yVal) noexcept : x(xVal), y(yVal) {}
+    constexpr explicit BoxT(const PointT<T>& pt) noexcept : x(pt.x), y(pt.y) {}
+    constexpr BoxT(T lx, T ly, T hx, T hy) noexcept : x(lx, hx), y(ly, hy) {}
+    constexpr BoxT(const IntervalT<T>& xRange, const IntervalT<T>& yRange) noexcept : x(xRange), y(yRange) {}
+    constexpr BoxT(const PointT<T>& low, const PointT<T>& high) noexcept : x(low.x, high.x), y(low.y, high.y) {}
 
     // Setters
-    T& lx() { return x.low; }
-    T& ly() { return y.low; }
-    T& hy() { return y.high; }
-    T& hx() { return x.high; }
-    IntervalT<T>& operator[](unsigned i) {
-        assert(i == 0 || i == 1);
-        return (i == 0) ? x : y;
-    }
-    void Set() {
+    constexpr T& lx() noexcept { return x.low; }
+    constexpr T& ly() noexcept { return y.low; }
+    constexpr T& hy() noexcept { return y.high; }
+    constexpr T& hx() noexcept { return x.high; }
+    // i is 0 (x) or 1 (y), unchecked
+    constexpr IntervalT<T>& operator[](unsigned i) noexcept { return (i == 0) ? x : y; }
+    constexpr void Set() noexcept {
         x.Set();
         y.Set();
     }
-    void Set(T xVal, T yVal) {
+    constexpr void Set(T xVal, T yVal) noexcept {
         x.Set(xVal);
         y.Set(yVal);
     }
-    void Set(const PointT<T>& pt) { Set(pt.x, pt.y); }
-    void Set(T lx, T ly, T hx, T hy) {
+    constexpr void Set(const PointT<T>& pt) noexcept { Set(pt.x, pt.y); }
+    constexpr void Set(T lx, T ly, T hx, T hy) noexcept {
         x.Set(lx, hx);
         y.Set(ly, hy);
     }
-    void Set(const IntervalT<T>& xRange, const IntervalT<T>& yRange) {
+    constexpr void Set(const IntervalT<T>& xRange, const IntervalT<T>& yRange) noexcept {
         x = xRange;
         y = yRange;
     }
-    void Set(const PointT<T>& low, const PointT<T>& high) { Set(low.x, low.y, high.x, high.y); }
+    constexpr void Set(const PointT<T>& low, const PointT<T>& high) noexcept { Set(low.x, low.y, high.x, high.y); }
 
     // Two types of boxes: normal & degenerated (line or point)
     // is valid box
-    bool IsValid() const { return x.IsValid() && y.IsValid(); }
+    constexpr bool IsValid() const noexcept { return x.IsValid() && y.IsValid(); }
     // is strictly valid box (excluding degenerated ones)
-    bool IsStrictValid() const { return x.IsStrictValid() && y.IsStrictValid(); }  // tighter
+    constexpr bool IsStrictValid() const noexcept { return x.IsStrictValid() && y.IsStrictValid(); }  // tighter
 
     // Getters
-    T lx() const { return x.low; }
-    T ly() const { return y.low; }
-    T hy() const { return y.high; }
-    T hx() const { return x.high; }
-    T cx() const { return x.center(); }
-    T cy() const { return y.center(); }
-    T width() const { return x.range(); }
-    T height() const { return y.range(); }
-    T hp() const { return width() + height(); }  // half perimeter
-    T area() const { return width() * height(); }
-    const IntervalT<T>& operator[](unsigned i) const {
-        assert(i == 0 || i == 1);
-        return (i == 0) ? x : y;
-    }
+    constexpr T lx() const noexcept { return x.low; }
+    constexpr T ly() const noexcept { return y.low; }
+    constexpr T hy() const noexcept { return y.high; }
+    constexpr T hx() const noexcept { return x.high; }
+    constexpr T cx() const noexcept { return x.center(); }
+    constexpr T cy() const noexcept { return y.center(); }
+    constexpr T width() const noexcept { return x.range(); }
+    constexpr T height() const noexcept { return y.range(); }
+    // half perimeter and area in the wide type (exact for integers)
+    constexpr WideT<T> hp() const noexcept { return (WideT<T>(x.high) - x.low) + (WideT<T>(y.high) - y.low); }
+    constexpr WideT<T> area() const noexcept { return (WideT<T>(x.high) - x.low) * (WideT<T>(y.high) - y.low); }
+    constexpr const IntervalT<T>& operator[](unsigned i) const noexcept { return (i == 0) ? x : y; }
 
     // Update() is always safe, FastUpdate() assumes existing values
-    void Update(T xVal, T yVal) {
+    constexpr void Update(T xVal, T yVal) noexcept {
         x.Update(xVal);
         y.Update(yVal);
     }
-    void FastUpdate(T xVal, T yVal) {
+    constexpr void FastUpdate(T xVal, T yVal) noexcept {
         x.FastUpdate(xVal);
         y.FastUpdate(yVal);
     }
-    void Update(const PointT<T>& pt) { Update(pt.x, pt.y); }
-    void FastUpdate(const PointT<T>& pt) { FastUpdate(pt.x, pt.y); }
+    constexpr void Update(const PointT<T>& pt) noexcept { Update(pt.x, pt.y); }
+    constexpr void FastUpdate(const PointT<T>& pt) noexcept { FastUpdate(pt.x, pt.y); }
 
     // Geometric Query/Update
-    BoxT UnionWith(const BoxT& rhs) const { return {x.UnionWith(rhs.x), y.UnionWith(rhs.y)}; }
-    BoxT IntersectWith(const BoxT& rhs) const { return {x.IntersectWith(rhs.x), y.IntersectWith(rhs.y)}; }
-    bool HasIntersectWith(const BoxT& rhs) const { return IntersectWith(rhs).IsValid(); }
-    bool HasStrictIntersectWith(const BoxT& rhs) const {  // tighter
+    constexpr BoxT UnionWith(const BoxT& rhs) const noexcept { return {x.UnionWith(rhs.x), y.UnionWith(rhs.y)}; }
+    constexpr BoxT IntersectWith(const BoxT& rhs) const noexcept {
+        return {x.IntersectWith(rhs.x), y.IntersectWith(rhs.y)};
+    }
+    constexpr bool HasIntersectWith(const BoxT& rhs) const noexcept { return IntersectWith(rhs).IsValid(); }
+    constexpr bool HasStrictIntersectWith(const BoxT& rhs) const noexcept {  // tighter
         return IntersectWith(rhs).IsStrictValid();
     }
-    PointT<T> GetNearestPointTo(const PointT<T>& pt) { return {x.GetNearestPointTo(pt.x), y.GetNearestPointTo(pt.y)}; }
-    BoxT GetNearestPointsTo(BoxT val) const { return {x.GetNearestPointsTo(val.x), y.GetNearestPointsTo(val.y)}; }
+    constexpr PointT<T> GetNearestPointTo(const PointT<T>& pt) const noexcept {
+        return {x.GetNearestPointTo(pt.x), y.GetNearestPointTo(pt.y)};
+    }
+    constexpr BoxT GetNearestPointsTo(BoxT val) const noexcept {
+        return {x.GetNearestPointsTo(val.x), y.GetNearestPointsTo(val.y)};
+    }
 
-    void ShiftBy(const PointT<T>& rhs) {
+    constexpr void ShiftBy(const PointT<T>& rhs) noexcept {
         x.ShiftBy(rhs.x);
         y.ShiftBy(rhs.y);
     }
 
-    bool operator==(const BoxT& rhs) const { return (x == rhs.x) && (y == rhs.y); }
-    bool operator!=(const BoxT& rhs) const { return !(*this == rhs); }
+    constexpr bool operator==(const BoxT& rhs) const noexcept { return (x == rhs.x) && (y == rhs.y); }
+    constexpr bool operator!=(const BoxT& rhs) const noexcept { return !(*this == rhs); }
 
     friend inline std::ostream& operator<<(std::ostream& os, const BoxT<T>& box) {
         os << "[x: " << box.x << ", y: " << box.y << "]";
@@ -289,20 +405,32 @@ public:
 
 // L-1 (Manhattan) distance between boxes/points (assume valid boxes)
 template <typename T>
-inline T Dist(const BoxT<T>& box, const PointT<T>& point) {
+constexpr T Dist(const BoxT<T>& box, const PointT<T>& point) noexcept {
     return Dist(box.x, point.x) + Dist(box.y, point.y);
 }
 template <typename T>
-inline T Dist(const BoxT<T>& box1, const BoxT<T>& box2) {
+constexpr T Dist(const BoxT<T>& box1, const BoxT<T>& box2) noexcept {
     return Dist(box1.x, box2.x) + Dist(box1.y, box2.y);
 }
 
+// Squared L-2 distance between boxes (exact for integers)
+template <typename T>
+constexpr WideT<T> SquaredL2Dist(const BoxT<T>& box1, const BoxT<T>& box2) noexcept {
+    WideT<T> dx = Dist(box1.x, box2.x), dy = Dist(box1.y, box2.y);
+    return dx * dx + dy * dy;
+}
+
 // L-2 (Euclidean) distance between boxes
 template <typename T>
 inline double L2Dist(const BoxT<T>& box1, const BoxT<T>& box2) {
-    return std::sqrt(std::pow(Dist(box1.x, box2.x), 2) + std::pow(Dist(box1.y, box2.y), 2));
+    return std::sqrt(static_cast<double>(SquaredL2Dist(box1, box2)));
 }
 
+static_assert(std::is_trivially_copyable<PointT<int>>::value && sizeof(PointT<int>) == 8, "PointT<int> layout");
+static_assert(std::is_trivially_copyable<IntervalT<int>>::value && sizeof(IntervalT<int>) == 8,
+              "IntervalT<int> layout");
+static_assert(std::is_trivially_copyable<BoxT<int>>::value && sizeof(BoxT<int>) == 16, "BoxT<int> layout");
+
 // Merge/stitch overlapped rectangles along mergeDir
 // mergeDir: 0 for x/vertical, 1 for y/horizontal
 // use BoxT instead of T & BoxT<T> to make it more general
@@ -373,7 +501,7 @@ template <typename T>
 class SegmentT : public BoxT<T> {
 public:
     using BoxT<T>::BoxT;
-    T length() const { return BoxT<T>::hp(); }
+    WideT<T> length() const { return BoxT<T>::hp(); }
     bool IsRectilinear() const { return BoxT<T>::x() == 0 || BoxT<T>::y() == 0; }
 };
 
@@ -0,0 +1,203 @@
+//
+// Versioned binary file format for point/interval/box collections, read back through mmap without copying
+//
+// Layout (native endianness, checked on open):
+//     GeoFileHeader | GeoFileColumn x numColumns | column data (each 64-byte aligned)
+// Column 0 holds the geometry records themselves (PointT<T>/IntervalT<T>/BoxT<T>, i.e., packed coordinates), so a
+// mapped file is directly viewed as span<const BoxT<T>>. Optional payload columns (e.g., net id, layer) follow as
+// separate fixed-size arrays with one element per record.
+//
+// Usage:
+//     WriteGeoFile("boxes.bin", boxes, {{"layer", sizeof(int), layers.data()}});
+//     GeoFileView<BoxT<int>> view;
+//     if (view.Open("boxes.bin")) {
+//         for (const auto& box : view.items()) ...;
+//         auto layers = view.payload<int>("layer");
+//     }
+//
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+#include "geo.h"
+#include "mapped_file.h"
+#include "span.h"
+
+namespace utils {
+
+struct GeoFileHeader {
+    char magic[8];            // "UTILSGEO"
+    uint32_t endianMark;      // 0x01020304 as written
+    uint32_t version;         // format version
+    uint32_t geoKind;         // GeoFileTraits::kind
+    uint32_t coordType;       // GeoFileTraits::coordType
+    uint64_t numRecords;
+    uint32_t numColumns;      // including the geometry column
+    uint32_t columnAlignment;
+};
+
+struct GeoFileColumn {
+    char name[48];      // null-terminated
+    uint64_t elemSize;  // bytes per record
+    uint64_t offset;    // from the beginning of the file
+};
+
+// Payload column to write: numRecords * elemSize bytes at data
+struct GeoPayloadColumn {
+    std::string name;
+    uint64_t elemSize;
+    const void* data;
+};
+
+template <typename T>
+struct GeoCoordType {
+    static constexpr uint32_t value = (std::is_floating_point<T>::value ? 0x100 : 0) |
+                                      (std::is_signed<T>::value ? 0x10 : 0) | static_cast<uint32_t>(sizeof(T));
+};
+
+template <typename Geo>
+struct GeoFileTraits;
+template <typename T>
+struct GeoFileTraits<PointT<T>> {
+    static constexpr uint32_t kind = 1, coordType = GeoCoordType<T>::value;
+};
+template <typename T>
+struct GeoFileTraits<IntervalT<T>> {
+    static constexpr uint32_t kind = 2, coordType = GeoCoordType<T>::value;
+};
+template <typename T>
+struct GeoFileTraits<BoxT<T>> {
+    static constexpr uint32_t kind = 3, coordType = GeoCoordType<T>::value;
+};
+
+constexpr uint32_t geoFileVersion = 1;
+constexpr uint32_t geoFileEndianMark = 0x01020304;
+constexpr uint32_t geoFileAlignment = 64;
+
+// Write geometry records and payload columns in one sequential pass, return false on I/O failure
+template <typename Geo>
+bool WriteGeoFile(std::ostream& os, const std::vector<Geo>& geos, const std::vector<GeoPayloadColumn>& payloads = {}) {
+    static_assert(std::is_trivially_copyable<Geo>::value, "geometry records must be trivially copyable");
+    GeoFileHeader header;
+    std::memcpy(header.magic, "UTILSGEO", 8);
+    header.endianMark = geoFileEndianMark;
+    header.version = geoFileVersion;
+    header.geoKind = GeoFileTraits<Geo>::kind;
+    header.coordType = GeoFileTraits<Geo>::coordType;
+    header.numRecords = geos.size();
+    header.numColumns = 1 + payloads.size();
+    header.columnAlignment = geoFileAlignment;
+
+    // column table
+    auto align = [](uint64_t offset) { return (offset + geoFileAlignment - 1) / geoFileAlignment * geoFileAlignment; };
+    std::vector<GeoFileColumn> columns(header.numColumns);
+    uint64_t offset = align(sizeof(GeoFileHeader) + sizeof(GeoFileColumn) * columns.size());
+    for (size_t i = 0; i < columns.size(); ++i) {
+        std::memset(columns[i].name, 0, sizeof(columns[i].name));
+        const std::string& name = i == 0 ? std::string("geometry") : payloads[i - 1].name;
+        std::memcpy(columns[i].name, name.data(), std::min(name.size(), sizeof(columns[i].name) - 1));
+        columns[i].elemSize = i == 0 ? sizeof(Geo) : payloads[i - 1].elemSize;
+        columns[i].offset = offset;
+        offset = align(offset + columns[i].elemSize * geos.size());
+    }
+
+    // header, column table, then column data with padding
+    uint64_t written = 0;
+    auto write = [&](const void* data, uint64_t size) {
+        os.write(static_cast<const char*>(data), size);
+        written += size;
+    };
+    auto pad = [&](uint64_t target) {
+        static const char zeros[geoFileAlignment] = {};
+        write(zeros, target - written);
+    };
+    write(&header, sizeof(header));
+    write(columns.data(), sizeof(GeoFileColumn) * columns.size());
+    for (size_t i = 0; i < columns.size(); ++i) {
+        pad(columns[i].offset);
+        write(i == 0 ? static_cast<const void*>(geos.data()) : payloads[i - 1].data, columns[i].elemSize * geos.size());
+    }
+    pad(offset);
+    return static_cast<bool>(os);
+}
+template <typename Geo>
+bool WriteGeoFile(const std::string& path,
+                  const std::vector<Geo>& geos,
+                  const std::vector<GeoPayloadColumn>& payloads = {}) {
+    std::ofstream ofs(path, std::ios::binary);
+    return ofs && WriteGeoFile(ofs, geos, payloads) && ofs.flush();
+}
+
+// Zero-copy read-only view of a file written by WriteGeoFile
+template <typename Geo>
+class GeoFileView {
+public:
+    // false if the file is missing, malformed, or of another version/geometry/coordinate type
+    bool Open(const std::string& path) {
+        _items = {};
+        if (!_file.Open(path)) return false;
+        if (!Parse()) {
+            _file.Close();
+            return false;
+        }
+        return true;
+    }
+    void Close() {
+        _file.Close();
+        _items = {};
+    }
+
+    span<const Geo> items() const { return _items; }
+    size_t size() const { return _items.size(); }
+    const Geo& operator[](size_t i) const { return _items[i]; }
+
+    // payload column by name (empty if missing or if P does not match its element size)
+    template <typename P>
+    span<const P> payload(const std::string& name) const {
+        if (!_file.IsOpen()) return {};
+        for (uint32_t i = 1; i < header().numColumns; ++i) {
+            const auto& column = columns()[i];
+            if (name == column.name && column.elemSize == sizeof(P)) {
+                return {reinterpret_cast<const P*>(_file.data() + column.offset), _items.size()};
+            }
+        }
+        return {};
+    }
+
+private:
+    MappedFile _file;
+    span<const Geo> _items;
+
+    const GeoFileHeader& header() const { return *reinterpret_cast<const GeoFileHeader*>(_file.data()); }
+    const GeoFileColumn* columns() const {
+        return reinterpret_cast<const GeoFileColumn*>(_file.data() + sizeof(GeoFileHeader));
+    }
+
+    bool Parse() {
+        if (_file.size() < sizeof(GeoFileHeader)) return false;
+        const auto& hdr = header();
+        if (std::memcmp(hdr.magic, "UTILSGEO", 8) != 0 || hdr.endianMark != geoFileEndianMark ||
+            hdr.version != geoFileVersion || hdr.geoKind != GeoFileTraits<Geo>::kind ||
+            hdr.coordType != GeoFileTraits<Geo>::coordType || hdr.numColumns == 0) {
+            return false;
+        }
+        if (_file.size() < sizeof(GeoFileHeader) + sizeof(GeoFileColumn) * uint64_t(hdr.numColumns)) return false;
+        for (uint32_t i = 0; i < hdr.numColumns; ++i) {
+            const auto& column = columns()[i];
+            if (column.name[sizeof(column.name) - 1] != '\0' || column.offset % geoFileAlignment != 0 ||
+                column.offset > _file.size()) {
+                return false;
+            }
+            if (column.elemSize > 0 && (_file.size() - column.offset) / column.elemSize < hdr.numRecords) return false;
+        }
+        if (columns()[0].elemSize != sizeof(Geo)) return false;
+        _items = {reinterpret_cast<const Geo*>(_file.data() + columns()[0].offset), hdr.numRecords};
+        return true;
+    }
+};
+
+}  // namespace utils
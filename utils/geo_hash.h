@@ -0,0 +1,305 @@
+//
+// Hashing of geometry primitives
+// 1. std::hash specializations for PointT, IntervalT and BoxT (all invalid intervals hash alike, as they compare equal)
+// 2. GeoHashMap/GeoHashSet: flat open-addressing tables with 16-slot group probing (SSE2 when available)
+//
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#include "geo.h"
+
+namespace utils {
+
+// Final mixer of MurmurHash3
+inline uint64_t HashMix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+inline uint64_t HashCombine(uint64_t seed, uint64_t val) {
+    return seed ^ (val * 0x9e3779b97f4a7c15ULL + 0x632be59bd9b4e019ULL + (seed << 6) + (seed >> 2));
+}
+
+// bits of a coordinate (-0.0 and 0.0 are the same)
+template <typename T>
+inline typename std::enable_if<std::is_integral<T>::value, uint64_t>::type HashBits(T val) {
+    return static_cast<uint64_t>(val);
+}
+template <typename T>
+inline typename std::enable_if<std::is_floating_point<T>::value, uint64_t>::type HashBits(T val) {
+    if (val == 0) val = 0;
+    uint64_t bits = 0;
+    std::memcpy(&bits, &val, std::min(sizeof(val), sizeof(bits)));
+    return bits;
+}
+
+template <typename T>
+inline uint64_t HashBits(const IntervalT<T>& intvl) {
+    return intvl.IsValid() ? HashCombine(HashBits(intvl.low), HashBits(intvl.high)) : 0x2545f4914f6cdd1dULL;
+}
+
+template <typename T>
+inline uint64_t HashValue(const PointT<T>& pt) {
+    return HashMix(HashCombine(HashBits(pt.x), HashBits(pt.y)));
+}
+template <typename T>
+inline uint64_t HashValue(const IntervalT<T>& intvl) {
+    return HashMix(HashBits(intvl));
+}
+template <typename T>
+inline uint64_t HashValue(const BoxT<T>& box) {
+    return HashMix(HashCombine(HashBits(box.x), HashBits(box.y)));
+}
+
+// Group of 16 control bytes, each of them is empty, deleted, or the low 7 bits of the hash of a full slot
+class HashCtrlGroup {
+public:
+    static constexpr int size = 16;
+    static constexpr int8_t empty = -128;
+    static constexpr int8_t deleted = -2;
+
+    explicit HashCtrlGroup(const int8_t* ctrl) : _ctrl(ctrl) {}
+
+    // bit i is set if control byte i equals val
+    uint32_t Match(int8_t val) const {
+#if defined(__SSE2__) || defined(_M_X64)
+        __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_ctrl));
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(val))));
+#else
+        uint32_t mask = 0;
+        for (int i = 0; i < size; ++i) mask |= static_cast<uint32_t>(_ctrl[i] == val) << i;
+        return mask;
+#endif
+    }
+    uint32_t MatchEmptyOrDeleted() const { return Match(empty) | Match(deleted); }
+
+    static int LowestBit(uint32_t mask) {
+#if defined(__GNUC__)
+        return __builtin_ctz(mask);
+#else
+        int i = 0;
+        while (!(mask & 1)) mask >>= 1, ++i;
+        return i;
+#endif
+    }
+
+private:
+    const int8_t* _ctrl;
+};
+
+// Open-addressing table of Slot (with a member "key"), the common part of GeoHashMap and GeoHashSet
+template <typename Key, typename Slot, typename Hash>
+class GeoHashTable {
+public:
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+    void Clear() {
+        _ctrl.assign(_ctrl.size(), HashCtrlGroup::empty);
+        _size = _numDeleted = 0;
+    }
+    // make room for num keys without rehashing
+    void Reserve(size_t num) {
+        size_t capacity = HashCtrlGroup::size;
+        while (capacity * 7 / 8 < num) capacity *= 2;
+        if (capacity > _slots.size()) Rehash(capacity);
+    }
+    bool Contains(const Key& key) const { return FindIdx(key, GetHash(key)) != npos; }
+    bool Erase(const Key& key) {
+        size_t i = FindIdx(key, GetHash(key));
+        if (i == npos) return false;
+        _ctrl[i] = HashCtrlGroup::deleted;
+        --_size;
+        ++_numDeleted;
+        return true;
+    }
+
+    // hash of key as used by the table (folded so that a weak Hash such as an identity still spreads)
+    uint64_t GetHash(const Key& key) const {
+        uint64_t hash = static_cast<uint64_t>(_hash(key)) * 0x9e3779b97f4a7c15ULL;
+        return hash ^ (hash >> 32);
+    }
+    // prefetch the first group probed for hash (for batch operations)
+    void Prefetch(uint64_t hash) const {
+#if defined(__GNUC__)
+        if (_slots.empty()) return;
+        size_t i = ((hash >> 7) & (_slots.size() / HashCtrlGroup::size - 1)) * HashCtrlGroup::size;
+        __builtin_prefetch(&_ctrl[i]);
+        __builtin_prefetch(&_slots[i]);
+#endif
+    }
+
+protected:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+    std::vector<int8_t> _ctrl;  // one per slot
+    std::vector<Slot> _slots;
+    size_t _size = 0, _numDeleted = 0;
+    Hash _hash;
+
+    // groups are probed in the triangular sequence, which visits all of them for a power-of-two count
+    size_t FindIdx(const Key& key, uint64_t hash) const {
+        if (_size == 0) return npos;
+        int8_t h2 = static_cast<int8_t>(hash & 0x7f);
+        size_t numGroups = _slots.size() / HashCtrlGroup::size, group = (hash >> 7) & (numGroups - 1);
+        for (size_t step = 1; step <= numGroups; ++step) {
+            size_t begin = group * HashCtrlGroup::size;
+            HashCtrlGroup ctrl(&_ctrl[begin]);
+            for (uint32_t match = ctrl.Match(h2); match; match &= match - 1) {
+                size_t i = begin + HashCtrlGroup::LowestBit(match);
+                if (_slots[i].key == key) return i;
+            }
+            if (ctrl.Match(HashCtrlGroup::empty)) return npos;
+            group = (group + step) & (numGroups - 1);
+        }
+        return npos;
+    }
+    size_t FindFreeIdx(uint64_t hash) const {
+        size_t numGroups = _slots.size() / HashCtrlGroup::size, group = (hash >> 7) & (numGroups - 1);
+        for (size_t step = 1;; ++step) {
+            size_t begin = group * HashCtrlGroup::size;
+            uint32_t match = HashCtrlGroup(&_ctrl[begin]).MatchEmptyOrDeleted();
+            if (match) return begin + HashCtrlGroup::LowestBit(match);
+            group = (group + step) & (numGroups - 1);
+        }
+    }
+
+    // slot index of key and whether it is newly inserted (its other members are then default-initialized)
+    std::pair<size_t, bool> FindOrInsert(const Key& key, uint64_t hash) {
+        size_t i = FindIdx(key, hash);
+        if (i != npos) return {i, false};
+        if ((_size + _numDeleted + 1) * 8 > _slots.size() * 7) {
+            // grow unless the load mostly consists of deleted slots
+            size_t capacity = std::max<size_t>(_slots.size(), HashCtrlGroup::size);
+            if ((_size + 1) * 16 > capacity * 7) capacity *= 2;
+            Rehash(capacity);
+        }
+        i = FindFreeIdx(hash);
+        if (_ctrl[i] == HashCtrlGroup::deleted) --_numDeleted;
+        _ctrl[i] = static_cast<int8_t>(hash & 0x7f);
+        _slots[i] = Slot();
+        _slots[i].key = key;
+        ++_size;
+        return {i, true};
+    }
+
+    void Rehash(size_t capacity) {
+        std::vector<int8_t> oldCtrl(capacity, HashCtrlGroup::empty);
+        std::vector<Slot> oldSlots(capacity);
+        oldCtrl.swap(_ctrl);  // now the old ones
+        oldSlots.swap(_slots);
+        _numDeleted = 0;
+        for (size_t i = 0; i < oldSlots.size(); ++i) {
+            if (oldCtrl[i] < 0) continue;
+            size_t j = FindFreeIdx(GetHash(oldSlots[i].key));
+            _ctrl[j] = oldCtrl[i];
+            _slots[j] = std::move(oldSlots[i]);
+        }
+    }
+};
+
+template <typename Key, typename Value>
+struct GeoHashMapSlot {
+    Key key;
+    Value value;
+};
+template <typename Key>
+struct GeoHashSetSlot {
+    Key key;
+};
+
+// Flat hash map (keys and values are stored inline, references are invalidated by insertions)
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class GeoHashMap : public GeoHashTable<Key, GeoHashMapSlot<Key, Value>, Hash> {
+public:
+    // false (and no update) if key exists
+    bool Insert(const Key& key, const Value& value) {
+        auto res = this->FindOrInsert(key, this->GetHash(key));
+        if (res.second) this->_slots[res.first].value = value;
+        return res.second;
+    }
+    Value& operator[](const Key& key) { return this->_slots[this->FindOrInsert(key, this->GetHash(key)).first].value; }
+    // nullptr if key does not exist
+    Value* Find(const Key& key) {
+        size_t i = this->FindIdx(key, this->GetHash(key));
+        return i == this->npos ? nullptr : &this->_slots[i].value;
+    }
+    const Value* Find(const Key& key) const {
+        size_t i = this->FindIdx(key, this->GetHash(key));
+        return i == this->npos ? nullptr : &this->_slots[i].value;
+    }
+    // func(key, value) on every entry
+    template <typename Func>
+    void ForEach(const Func& func) const {
+        for (size_t i = 0; i < this->_slots.size(); ++i) {
+            if (this->_ctrl[i] >= 0) func(this->_slots[i].key, this->_slots[i].value);
+        }
+    }
+};
+
+// Flat hash set
+template <typename Key, typename Hash = std::hash<Key>>
+class GeoHashSet : public GeoHashTable<Key, GeoHashSetSlot<Key>, Hash> {
+public:
+    // false if key exists
+    bool Insert(const Key& key) { return this->FindOrInsert(key, this->GetHash(key)).second; }
+    bool Insert(const Key& key, uint64_t hash) { return this->FindOrInsert(key, hash).second; }  // hash by GetHash
+    // func(key) on every key
+    template <typename Func>
+    void ForEach(const Func& func) const {
+        for (size_t i = 0; i < this->_slots.size(); ++i) {
+            if (this->_ctrl[i] >= 0) func(this->_slots[i].key);
+        }
+    }
+};
+
+// Remove duplicates in place, keeping the first occurrences in order
+template <typename Key, typename Hash = std::hash<Key>>
+void RemoveDuplicates(std::vector<Key>& keys) {
+    GeoHashSet<Key, Hash> seen;
+    seen.Reserve(keys.size());
+    // hashes are computed a few keys ahead to prefetch their groups
+    const size_t lookAhead = 16;
+    std::vector<uint64_t> hashes(lookAhead);
+    size_t num = 0;
+    for (size_t i = 0; i < keys.size() + lookAhead; ++i) {
+        if (i >= lookAhead) {
+            size_t j = i - lookAhead;
+            if (seen.Insert(keys[j], hashes[j % lookAhead])) keys[num++] = keys[j];
+        }
+        if (i < keys.size()) {
+            hashes[i % lookAhead] = seen.GetHash(keys[i]);
+            seen.Prefetch(hashes[i % lookAhead]);
+        }
+    }
+    keys.resize(num);
+}
+
+}  // namespace utils
+
+namespace std {
+
+template <typename T>
+struct hash<utils::PointT<T>> {
+    size_t operator()(const utils::PointT<T>& pt) const { return static_cast<size_t>(utils::HashValue(pt)); }
+};
+template <typename T>
+struct hash<utils::IntervalT<T>> {
+    size_t operator()(const utils::IntervalT<T>& intvl) const { return static_cast<size_t>(utils::HashValue(intvl)); }
+};
+template <typename T>
+struct hash<utils::BoxT<T>> {
+    size_t operator()(const utils::BoxT<T>& box) const { return static_cast<size_t>(utils::HashValue(box)); }
+};
+
+}  // namespace std
@@ -0,0 +1,186 @@
+//
+// Fast text parser of point/interval/box records in the format printed by their operator<<
+//     PointT: (x, y)    IntervalT: (low, high)    BoxT: [x: (lx, hx), y: (ly, hy)]
+// Numbers are read by std::from_chars (no locale, no istream). Records may be separated by whitespace, ',', '[' or
+// ']' (so printed vectors parse too) but must not span lines, which lets large inputs be cut into chunks at line
+// boundaries and parsed by multiple threads.
+//
+// Usage:
+//     std::vector<BoxT<int>> boxes;
+//     if (!ParseGeoFile("boxes.txt", boxes)) ...;
+//
+
+#pragma once
+
+#include <charconv>
+#include <cstring>
+#include <fstream>
+
+#include "geo.h"
+#include "mapped_file.h"
+#include "parallel.h"
+
+namespace utils {
+
+class GeoTextCursor {
+public:
+    GeoTextCursor(const char* begin, const char* end) : _cur(begin), _end(end) {}
+
+    bool IsEnd() const { return _cur == _end; }
+    char Peek() const { return _cur == _end ? '\0' : *_cur; }
+    void SkipSpaces() {
+        while (_cur != _end && (*_cur == ' ' || *_cur == '\t' || *_cur == '\r' || *_cur == '\n')) ++_cur;
+    }
+    // skip separators between records, false if something else is found before the next record start
+    bool SkipToRecord(char start) {
+        for (; _cur != _end; ++_cur) {
+            char c = *_cur;
+            if (c == start) {
+                if (start != '[' || IsBoxStart()) return true;
+            } else if (c != ' ' && c != '\t' && c != '\r' && c != '\n' && c != ',' && c != '[' && c != ']') {
+                return false;
+            }
+        }
+        return true;
+    }
+    bool Expect(char c) {
+        SkipSpaces();
+        if (Peek() != c) return false;
+        ++_cur;
+        return true;
+    }
+    template <typename T>
+    bool Number(T& val) {
+        SkipSpaces();
+        if (_cur != _end && *_cur == '+') ++_cur;
+        auto res = std::from_chars(_cur, _end, val);
+        if (res.ec != std::errc()) return false;
+        _cur = res.ptr;
+        return true;
+    }
+
+private:
+    const char* _cur;
+    const char* _end;
+
+    // at '[' followed by "x:" (a box rather than a bracket of a printed vector)
+    bool IsBoxStart() const {
+        const char* p = _cur + 1;
+        while (p != _end && (*p == ' ' || *p == '\t')) ++p;
+        return p != _end && *p == 'x';
+    }
+};
+
+template <typename T>
+inline bool ParseGeoRecord(GeoTextCursor& cursor, PointT<T>& pt) {
+    return cursor.Expect('(') && cursor.Number(pt.x) && cursor.Expect(',') && cursor.Number(pt.y) &&
+           cursor.Expect(')');
+}
+template <typename T>
+inline bool ParseGeoRecord(GeoTextCursor& cursor, IntervalT<T>& intvl) {
+    return cursor.Expect('(') && cursor.Number(intvl.low) && cursor.Expect(',') && cursor.Number(intvl.high) &&
+           cursor.Expect(')');
+}
+template <typename T>
+inline bool ParseGeoRecord(GeoTextCursor& cursor, BoxT<T>& box) {
+    return cursor.Expect('[') && cursor.Expect('x') && cursor.Expect(':') && ParseGeoRecord(cursor, box.x) &&
+           cursor.Expect(',') && cursor.Expect('y') && cursor.Expect(':') && ParseGeoRecord(cursor, box.y) &&
+           cursor.Expect(']');
+}
+
+template <typename T>
+inline char GeoRecordStart(const PointT<T>*) {
+    return '(';
+}
+template <typename T>
+inline char GeoRecordStart(const IntervalT<T>*) {
+    return '(';
+}
+template <typename T>
+inline char GeoRecordStart(const BoxT<T>*) {
+    return '[';
+}
+
+// Parse all records in [begin, end) and append them to geos, false on malformed text (geos is then incomplete)
+// Texts larger than chunkSize are cut at line boundaries and parsed in parallel; the record order is kept.
+template <typename Geo>
+bool ParseGeoText(const char* begin,
+                  const char* end,
+                  std::vector<Geo>& geos,
+                  int numThreads = 0,
+                  size_t chunkSize = 1 << 20) {
+    const char start = GeoRecordStart(static_cast<const Geo*>(nullptr));
+    auto parseChunk = [start](const char* lo, const char* hi, std::vector<Geo>& out) {
+        GeoTextCursor cursor(lo, hi);
+        Geo geo;
+        while (true) {
+            if (!cursor.SkipToRecord(start)) return false;
+            if (cursor.IsEnd()) return true;
+            if (!ParseGeoRecord(cursor, geo)) return false;
+            out.push_back(geo);
+        }
+    };
+
+    // chunk boundaries, each moved forward to the next line start
+    numThreads = GetNumThreads(numThreads);
+    size_t size = end - begin;
+    if (numThreads == 1 || size <= chunkSize) return parseChunk(begin, end, geos);
+    std::vector<const char*> cuts = {begin};
+    for (size_t offset = chunkSize; offset < size; offset += chunkSize) {
+        const char* cut = std::max(cuts.back(), begin + offset);
+        const char* newline = static_cast<const char*>(std::memchr(cut, '\n', end - cut));
+        cut = newline ? newline + 1 : end;
+        if (cut != cuts.back()) cuts.push_back(cut);
+    }
+    if (cuts.back() != end) cuts.push_back(end);
+
+    size_t numChunks = cuts.size() - 1;
+    std::vector<std::vector<Geo>> chunkGeos(numChunks);
+    std::vector<char> isChunkOk(numChunks);
+    ParallelFor(
+        0,
+        numChunks,
+        [&](size_t i) { isChunkOk[i] = parseChunk(cuts[i], cuts[i + 1], chunkGeos[i]); },
+        numThreads,
+        1);
+    size_t numGeos = geos.size();
+    for (const auto& chunk : chunkGeos) numGeos += chunk.size();
+    geos.reserve(numGeos);
+    for (size_t i = 0; i < numChunks; ++i) {
+        if (!isChunkOk[i]) return false;
+        geos.insert(geos.end(), chunkGeos[i].begin(), chunkGeos[i].end());
+    }
+    return true;
+}
+
+// Parse records from a stream read in blocks of about chunkSize bytes (the partial last line of a block is carried
+// over to the next one), each block is parsed in parallel
+template <typename Geo>
+bool ParseGeoStream(std::istream& is, std::vector<Geo>& geos, int numThreads = 0, size_t chunkSize = 1 << 24) {
+    std::vector<char> buffer;
+    size_t carry = 0;
+    while (is) {
+        buffer.resize(carry + chunkSize);
+        is.read(buffer.data() + carry, chunkSize);
+        size_t size = carry + is.gcount(), numParsed = size;
+        if (is) {
+            // keep the unfinished line (or the whole block if no line ends in it yet)
+            while (numParsed > 0 && buffer[numParsed - 1] != '\n') --numParsed;
+        }
+        if (numParsed > 0 && !ParseGeoText(buffer.data(), buffer.data() + numParsed, geos, numThreads)) return false;
+        carry = size - numParsed;
+        std::memmove(buffer.data(), buffer.data() + numParsed, carry);
+    }
+    return !is.bad();
+}
+
+// Parse records from a file, through mmap when possible
+template <typename Geo>
+bool ParseGeoFile(const std::string& path, std::vector<Geo>& geos, int numThreads = 0) {
+    MappedFile file;
+    if (file.Open(path)) return ParseGeoText(file.data(), file.data() + file.size(), geos, numThreads);
+    std::ifstream ifs(path, std::ios::binary);
+    return ifs && ParseGeoStream(ifs, geos, numThreads);
+}
+
+}  // namespace utils
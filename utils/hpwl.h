@@ -0,0 +1,194 @@
+//
+// Half-perimeter wirelength (HPWL) of a netlist
+// Pin locations are stored in CSR order (the pins of a net are contiguous), so the bound of a net is one min/max
+// reduction over a contiguous PointT array, done with SSE2 for int and double coordinates. Evaluate() runs over
+// nets in parallel and caches the HPWL of every net; MoveDelta()/MovePins() only visit the nets of the moved pins, and
+// MoveDelta() is const and reentrant with a MoveScratch per caller (e.g., per thread), reused across calls.
+//
+// Usage:
+//     NetlistHpwlT<int> hpwl(netBegins, netPins, pinLocs);  // pins of net i: netPins[netBegins[i], netBegins[i+1])
+//     NetlistHpwlT<int>::MoveScratch scratch;  // one per thread evaluating moves
+//     auto delta = hpwl.MoveDelta(movedPins, newLocs, scratch);
+//     if (delta < 0) hpwl.MovePins(movedPins, newLocs);
+//
+
+#pragma once
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#include "geo.h"
+#include "parallel.h"
+#include "span.h"
+
+namespace utils {
+
+// Bounding box of pts[0, n) (invalid if n = 0)
+template <typename T>
+inline BoxT<T> PointsBound(const PointT<T>* pts, size_t n) {
+    BoxT<T> box;
+    for (size_t i = 0; i < n; ++i) box.Update(pts[i]);
+    return box;
+}
+#if defined(__SSE2__) || defined(_M_X64)
+// two points (x0, y0, x1, y1) per vector
+inline BoxT<int> PointsBound(const PointT<int>* pts, size_t n) {
+    BoxT<int> box;
+    size_t i = 0;
+    if (n >= 4) {
+        auto load = [&](size_t k) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(pts + k)); };
+        __m128i lo = load(0), hi = lo;
+        for (i = 2; i + 2 <= n; i += 2) {
+            __m128i val = load(i);
+            __m128i isLess = _mm_cmplt_epi32(val, lo), isGreater = _mm_cmpgt_epi32(val, hi);
+            lo = _mm_or_si128(_mm_and_si128(isLess, val), _mm_andnot_si128(isLess, lo));
+            hi = _mm_or_si128(_mm_and_si128(isGreater, val), _mm_andnot_si128(isGreater, hi));
+        }
+        int los[4], his[4];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(los), lo);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(his), hi);
+        box.Set(std::min(los[0], los[2]), std::min(los[1], los[3]), std::max(his[0], his[2]), std::max(his[1], his[3]));
+    }
+    for (; i < n; ++i) box.Update(pts[i]);
+    return box;
+}
+// one point (x, y) per vector
+inline BoxT<double> PointsBound(const PointT<double>* pts, size_t n) {
+    BoxT<double> box;
+    if (n == 0) return box;
+    __m128d lo = _mm_loadu_pd(&pts[0].x), hi = lo;
+    for (size_t i = 1; i < n; ++i) {
+        __m128d val = _mm_loadu_pd(&pts[i].x);
+        lo = _mm_min_pd(lo, val);
+        hi = _mm_max_pd(hi, val);
+    }
+    double los[2], his[2];
+    _mm_storeu_pd(los, lo);
+    _mm_storeu_pd(his, hi);
+    box.Set(los[0], los[1], his[0], his[1]);
+    return box;
+}
+#endif
+
+template <typename T>
+class NetlistHpwlT {
+public:
+    NetlistHpwlT() = default;
+    NetlistHpwlT(const std::vector<int>& netBegins,
+                 const std::vector<int>& netPins,
+                 const std::vector<PointT<T>>& pinLocs,
+                 int numThreads = 0) {
+        Build(netBegins, netPins, pinLocs, numThreads);
+    }
+
+    // netPins[netBegins[i], netBegins[i + 1]) are the pins (indices into pinLocs) of net i, a pin is in at most one net
+    void Build(const std::vector<int>& netBegins,
+               const std::vector<int>& netPins,
+               const std::vector<PointT<T>>& pinLocs,
+               int numThreads = 0) {
+        _netBegins = netBegins.empty() ? std::vector<int>{0} : netBegins;
+        _pinSlots.assign(pinLocs.size(), -1);
+        _slotNets.resize(netPins.size());
+        _locs.resize(netPins.size());
+        for (int net = 0; net + 1 < static_cast<int>(_netBegins.size()); ++net) {
+            for (int slot = _netBegins[net]; slot < _netBegins[net + 1]; ++slot) {
+                _pinSlots[netPins[slot]] = slot;
+                _slotNets[slot] = net;
+                _locs[slot] = pinLocs[netPins[slot]];
+            }
+        }
+        Evaluate(numThreads);
+    }
+
+    size_t numNets() const { return _netBegins.size() - 1; }
+    size_t numPins() const { return _pinSlots.size(); }
+    // invalid if the pin is in no net
+    PointT<T> pinLoc(int pin) const { return _pinSlots[pin] >= 0 ? _locs[_pinSlots[pin]] : PointT<T>(); }
+    int pinNet(int pin) const { return _pinSlots[pin] >= 0 ? _slotNets[_pinSlots[pin]] : -1; }
+
+    BoxT<T> NetBound(int net) const {
+        return PointsBound(_locs.data() + _netBegins[net], _netBegins[net + 1] - _netBegins[net]);
+    }
+    // cached, as of the last Evaluate()/MovePins()
+    WideT<T> NetHpwl(int net) const { return _netHpwls[net]; }
+    WideT<T> total() const { return _total; }
+
+    // recompute the HPWL of all nets
+    WideT<T> Evaluate(int numThreads = 0) {
+        _netHpwls.resize(numNets());
+        ParallelFor(
+            0, numNets(), [&](size_t net) { _netHpwls[net] = GetHpwl(NetBound(net)); }, numThreads, 4096);
+        _total = 0;
+        for (const auto& hpwl : _netHpwls) _total += hpwl;
+        return _total;
+    }
+
+    // Buffers of MoveDelta(), kept by the caller (e.g., one per thread) to avoid allocations per call
+    struct MoveScratch {
+        std::vector<std::pair<int, int>> moves;  // (slot, k) of the moved pins, by slot
+        std::vector<PointT<T>> netLocs;
+    };
+
+    // HPWL change if pins[k] were moved to locs[k] (pins are distinct), only the nets of the moved pins are visited
+    WideT<T> MoveDelta(span<const int> pins, span<const PointT<T>> locs, MoveScratch& scratch) const {
+        WideT<T> delta = 0;
+        ForEachMovedNet(pins, locs, scratch.moves, [&](int net, span<const std::pair<int, int>> moves) {
+            auto& netLocs = scratch.netLocs;
+            netLocs.assign(_locs.begin() + _netBegins[net], _locs.begin() + _netBegins[net + 1]);
+            for (const auto& move : moves) netLocs[move.first - _netBegins[net]] = locs[move.second];
+            delta += GetHpwl(PointsBound(netLocs.data(), netLocs.size())) - _netHpwls[net];
+        });
+        return delta;
+    }
+    WideT<T> MoveDelta(span<const int> pins, span<const PointT<T>> locs) const {
+        MoveScratch scratch;
+        return MoveDelta(pins, locs, scratch);
+    }
+    // move pins[k] to locs[k] and update the cached HPWL, return the change
+    WideT<T> MovePins(span<const int> pins, span<const PointT<T>> locs) {
+        WideT<T> delta = 0;
+        ForEachMovedNet(pins, locs, _moves, [&](int net, span<const std::pair<int, int>> moves) {
+            for (const auto& move : moves) _locs[move.first] = locs[move.second];
+            WideT<T> hpwl = GetHpwl(NetBound(net));
+            delta += hpwl - _netHpwls[net];
+            _netHpwls[net] = hpwl;
+        });
+        _total += delta;
+        return delta;
+    }
+
+private:
+    std::vector<int> _netBegins;
+    std::vector<PointT<T>> _locs;  // pin locations in net order
+    std::vector<int> _slotNets;    // net of each slot
+    std::vector<int> _pinSlots;    // position of each pin in _locs, -1 if in no net
+    std::vector<WideT<T>> _netHpwls;
+    WideT<T> _total = 0;
+    std::vector<std::pair<int, int>> _moves;  // buffer of MovePins()
+
+    static WideT<T> GetHpwl(const BoxT<T>& bound) { return bound.IsValid() ? bound.hp() : 0; }
+
+    // func(net, moves) on every net with moved pins, moves are (slot, k) of its moved pins
+    // The moves are sorted by slot, so they are grouped by net (only the moved pins are sorted, not the nets).
+    template <typename Func>
+    void ForEachMovedNet(span<const int> pins,
+                         span<const PointT<T>> locs,
+                         std::vector<std::pair<int, int>>& moves,
+                         const Func& func) const {
+        moves.clear();
+        for (int k = 0; k < static_cast<int>(std::min(pins.size(), locs.size())); ++k) {
+            if (_pinSlots[pins[k]] >= 0) moves.emplace_back(_pinSlots[pins[k]], k);
+        }
+        std::sort(moves.begin(), moves.end());
+        for (size_t i = 0; i < moves.size();) {
+            int net = _slotNets[moves[i].first];
+            size_t j = i + 1;
+            while (j < moves.size() && _slotNets[moves[j].first] == net) ++j;
+            func(net, span<const std::pair<int, int>>(moves.data() + i, j - i));
+            i = j;
+        }
+    }
+};
+
+}  // namespace utils
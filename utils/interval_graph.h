@@ -0,0 +1,86 @@
+//
+// Interval graph problems on closed intervals (two intervals conflict if they HasIntersectWith, touching included)
+// 1. AssignTracks: left-edge track assignment (interval graph coloring) with a min-heap of track ends, optimal
+// 2. MaxWeightIndependentIntervals: weighted maximum set of pairwise disjoint intervals (DP over sorted ends)
+// Both are O(n log n) and only allocate a few arrays of size n.
+//
+// Usage:
+//     vector<int> tracks;
+//     int numTracks = AssignTracks(wireSpans, tracks);
+//
+
+#pragma once
+
+#include "geo.h"
+
+namespace utils {
+
+// tracks[i]: track of intvls[i] in [0, numTracks) (-1 for invalid ones), return numTracks
+// Intervals are visited by low end; each takes the track that became free the earliest, or a new one if none is free,
+// so numTracks equals the maximum number of intervals sharing a point.
+template <typename T>
+int AssignTracks(const std::vector<IntervalT<T>>& intvls, std::vector<int>& tracks) {
+    std::vector<int> order;
+    order.reserve(intvls.size());
+    for (int i = 0; i < static_cast<int>(intvls.size()); ++i) {
+        if (intvls[i].IsValid()) order.push_back(i);
+    }
+    std::sort(order.begin(), order.end(), [&](int lhs, int rhs) { return intvls[lhs].low < intvls[rhs].low; });
+    tracks.assign(intvls.size(), -1);
+    // (high end of the last interval, track), min-heap on the high end
+    std::vector<std::pair<T, int>> heap;
+    heap.reserve(order.size());
+    auto cmp = [](const std::pair<T, int>& lhs, const std::pair<T, int>& rhs) { return lhs.first > rhs.first; };
+    int numTracks = 0;
+    for (int i : order) {
+        if (!heap.empty() && heap.front().first < intvls[i].low) {
+            std::pop_heap(heap.begin(), heap.end(), cmp);
+            heap.back().first = intvls[i].high;
+            tracks[i] = heap.back().second;
+        } else {
+            heap.emplace_back(intvls[i].high, numTracks);
+            tracks[i] = numTracks++;
+        }
+        std::push_heap(heap.begin(), heap.end(), cmp);
+    }
+    return numTracks;
+}
+
+// Maximum total weight of pairwise disjoint intervals, selected gets their indices (ascending)
+// Intervals that are invalid or have non-positive weights are never selected.
+template <typename T, typename W>
+W MaxWeightIndependentIntervals(const std::vector<IntervalT<T>>& intvls,
+                                const std::vector<W>& weights,
+                                std::vector<int>& selected) {
+    std::vector<int> order;
+    order.reserve(intvls.size());
+    for (int i = 0; i < static_cast<int>(intvls.size()); ++i) {
+        if (intvls[i].IsValid() && weights[i] > 0) order.push_back(i);
+    }
+    std::sort(order.begin(), order.end(), [&](int lhs, int rhs) { return intvls[lhs].high < intvls[rhs].high; });
+    // best[k]: optimum over the first k intervals by high end, prev[k]: number of them ending before order[k] starts
+    size_t n = order.size();
+    std::vector<W> best(n + 1, 0);
+    std::vector<int> prev(n);
+    for (size_t k = 0; k < n; ++k) {
+        const auto& intvl = intvls[order[k]];
+        prev[k] = std::partition_point(order.begin(),
+                                       order.begin() + k,
+                                       [&](int i) { return intvls[i].high < intvl.low; }) -
+                  order.begin();
+        best[k + 1] = std::max(best[k], best[prev[k]] + weights[order[k]]);
+    }
+    selected.clear();
+    for (size_t k = n; k > 0;) {
+        if (best[k] == best[k - 1]) {
+            --k;
+        } else {
+            selected.push_back(order[k - 1]);
+            k = prev[k - 1];
+        }
+    }
+    std::sort(selected.begin(), selected.end());
+    return best[n];
+}
+
+}  // namespace utils
@@ -0,0 +1,81 @@
+#include "mapped_file.h"
+
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+namespace utils {
+
+MappedFile& MappedFile::operator=(MappedFile&& rhs) noexcept {
+    if (this != &rhs) {
+        Close();
+        std::swap(_data, rhs._data);
+        std::swap(_size, rhs._size);
+        std::swap(_handle, rhs._handle);
+    }
+    return *this;
+}
+
+bool MappedFile::Open(const std::string& path) {
+    Close();
+#if defined(__unix__) || defined(__APPLE__)
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return false;
+    }
+    void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);  // the mapping keeps the file referenced
+    if (addr == MAP_FAILED) return false;
+    _data = static_cast<const char*>(addr);
+    _size = st.st_size;
+    return true;
+#elif defined(_WIN32)
+    HANDLE file = CreateFileA(
+        path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (mapping == NULL) return false;
+    void* addr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (addr == NULL) {
+        CloseHandle(mapping);
+        return false;
+    }
+    _data = static_cast<const char*>(addr);
+    _size = fileSize.QuadPart;
+    _handle = mapping;
+    return true;
+#else
+    return false;  // unsupported
+#endif
+}
+
+void MappedFile::Close() {
+    if (_data == nullptr) return;
+#if defined(__unix__) || defined(__APPLE__)
+    munmap(const_cast<char*>(_data), _size);
+#elif defined(_WIN32)
+    UnmapViewOfFile(_data);
+    CloseHandle(_handle);
+#endif
+    _data = nullptr;
+    _size = 0;
+    _handle = nullptr;
+}
+
+}  // namespace utils
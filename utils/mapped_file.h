@@ -0,0 +1,35 @@
+//
+// Read-only memory-mapped file
+// The mapping is shared, so processes mapping the same file share one page-cached copy.
+//
+
+#pragma once
+
+#include <string>
+#include <utility>
+
+namespace utils {
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& rhs) noexcept { *this = std::move(rhs); }
+    MappedFile& operator=(MappedFile&& rhs) noexcept;
+    ~MappedFile() { Close(); }
+
+    bool Open(const std::string& path);  // false if the file cannot be opened/mapped
+    void Close();
+
+    bool IsOpen() const { return _data != nullptr; }
+    const char* data() const { return _data; }
+    size_t size() const { return _size; }
+
+private:
+    const char* _data = nullptr;
+    size_t _size = 0;
+    void* _handle = nullptr;  // file mapping handle (Windows only)
+};
+
+}  // namespace utils
@@ -0,0 +1,302 @@
+//
+// Static packed Hilbert R-tree over a box set, persistent and pointer-free
+// Boxes are sorted by the Hilbert value of their centers and packed bottom-up into nodes of nodeSize children. All
+// nodes live in one array (leaves first, root last) and refer to their children by position, so the tree can be
+// written to disk and queried straight from an mmap-ed file; processes opening the same file share its page cache.
+//
+// Usage:
+//     PackedRTreeT<int> tree(boxes);
+//     tree.Write("layout.rtree");
+//     ...
+//     PackedRTreeT<int> mapped;
+//     if (mapped.Open("layout.rtree")) mapped.Query(window, [&](int boxIdx) { ... });
+//
+
+#pragma once
+
+#include "geo_file.h"
+
+namespace utils {
+
+// Position of (x, y) on the Hilbert curve of a 2^16 x 2^16 grid
+inline uint32_t HilbertIndex(uint32_t x, uint32_t y) {
+    const uint32_t n = 1u << 16;
+    uint32_t d = 0;
+    for (uint32_t s = n / 2; s > 0; s /= 2) {
+        uint32_t rx = (x & s) > 0, ry = (y & s) > 0;
+        d += s * s * ((3 * rx) ^ ry);
+        if (ry == 0) {
+            if (rx == 1) {
+                x = n - 1 - x;
+                y = n - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
+
+struct PackedRTreeHeader {
+    char magic[8];        // "UTILSRTR"
+    uint32_t endianMark;  // geoFileEndianMark
+    uint32_t version;
+    uint32_t coordType;   // GeoCoordType
+    uint32_t nodeSize;
+    uint64_t numItems;
+    uint64_t numNodes;
+    uint32_t numLevels;
+    uint32_t numBoxes;  // size of the box set built from (leaf items index it)
+    uint64_t nodesOffset;  // BoxT<T>[numNodes]
+    uint64_t idxsOffset;   // int32_t[numNodes]
+};
+
+template <typename T>
+class PackedRTreeT {
+public:
+    PackedRTreeT() = default;
+    PackedRTreeT(const std::vector<BoxT<T>>& boxes, int nodeSize = 16) { Build(boxes, nodeSize); }
+    PackedRTreeT(const PackedRTreeT&) = delete;
+    PackedRTreeT& operator=(const PackedRTreeT&) = delete;
+    PackedRTreeT(PackedRTreeT&& rhs) noexcept { *this = std::move(rhs); }
+    PackedRTreeT& operator=(PackedRTreeT&& rhs) noexcept {
+        if (this == &rhs) return *this;
+        Clear();
+        _nodeStore = std::move(rhs._nodeStore);
+        _idxStore = std::move(rhs._idxStore);
+        _levelEndStore = std::move(rhs._levelEndStore);
+        _file = std::move(rhs._file);
+        if (_file.IsOpen()) {
+            _nodes = rhs._nodes;  // the mapping keeps its address
+            _idxs = rhs._idxs;
+            _levelEnds = rhs._levelEnds;
+        } else {
+            _nodes = _nodeStore.data();
+            _idxs = _idxStore.data();
+            _levelEnds = _levelEndStore.data();
+        }
+        _numItems = rhs._numItems;
+        _numNodes = rhs._numNodes;
+        _numLevels = rhs._numLevels;
+        _numBoxes = rhs._numBoxes;
+        _nodeSize = rhs._nodeSize;
+        rhs.Clear();
+        return *this;
+    }
+
+    // build in memory (invalid boxes are skipped)
+    void Build(const std::vector<BoxT<T>>& boxes, int nodeSize = 16) {
+        _file.Close();
+        _nodeSize = std::max(nodeSize, 2);
+        std::vector<int> items;
+        BoxT<T> bound;
+        for (int i = 0; i < static_cast<int>(boxes.size()); ++i) {
+            if (!boxes[i].IsValid()) continue;
+            items.push_back(i);
+            bound = bound.UnionWith(boxes[i]);
+        }
+
+        // leaves in Hilbert order of the box centers
+        std::vector<std::pair<uint32_t, int>> keys(items.size());
+        double width = items.empty() ? 0 : static_cast<double>(bound.hx()) - bound.lx();
+        double height = items.empty() ? 0 : static_cast<double>(bound.hy()) - bound.ly();
+        double scaleX = width > 0 ? 65535.0 / width : 0, scaleY = height > 0 ? 65535.0 / height : 0;
+        for (size_t i = 0; i < items.size(); ++i) {
+            const auto& box = boxes[items[i]];
+            double cx = (static_cast<double>(box.lx()) + box.hx()) / 2 - bound.lx();
+            double cy = (static_cast<double>(box.ly()) + box.hy()) / 2 - bound.ly();
+            keys[i] = {HilbertIndex(static_cast<uint32_t>(cx * scaleX), static_cast<uint32_t>(cy * scaleY)), items[i]};
+        }
+        std::sort(keys.begin(), keys.end());
+        _nodeStore.clear();
+        _idxStore.clear();
+        _levelEndStore.clear();
+        for (const auto& key : keys) {
+            _nodeStore.push_back(boxes[key.second]);
+            _idxStore.push_back(key.second);
+        }
+        _numItems = _nodeStore.size();
+        _numBoxes = boxes.size();
+
+        // pack upper levels until a single root remains
+        if (!_nodeStore.empty()) _levelEndStore.push_back(_nodeStore.size());
+        for (uint64_t begin = 0; !_nodeStore.empty() && _nodeStore.size() - begin > 1;) {
+            uint64_t end = _nodeStore.size();
+            for (uint64_t child = begin; child < end; child += _nodeSize) {
+                BoxT<T> nodeBound;
+                for (uint64_t k = child; k < std::min<uint64_t>(child + _nodeSize, end); ++k) {
+                    nodeBound = nodeBound.UnionWith(_nodeStore[k]);
+                }
+                _nodeStore.push_back(nodeBound);
+                _idxStore.push_back(static_cast<int32_t>(child));
+            }
+            _levelEndStore.push_back(_nodeStore.size());
+            begin = end;
+        }
+        _nodes = _nodeStore.data();
+        _idxs = _idxStore.data();
+        _levelEnds = _levelEndStore.data();
+        _numNodes = _nodeStore.size();
+        _numLevels = _levelEndStore.size();
+    }
+
+    // write the tree in the binary format that Open() maps, return false on I/O failure
+    bool Write(std::ostream& os) const {
+        PackedRTreeHeader header;
+        std::memcpy(header.magic, "UTILSRTR", 8);
+        header.endianMark = geoFileEndianMark;
+        header.version = version;
+        header.coordType = GeoCoordType<T>::value;
+        header.nodeSize = _nodeSize;
+        header.numItems = _numItems;
+        header.numNodes = _numNodes;
+        header.numLevels = _numLevels;
+        header.numBoxes = _numBoxes;
+        auto align = [](uint64_t offset) {
+            return (offset + geoFileAlignment - 1) / geoFileAlignment * geoFileAlignment;
+        };
+        header.nodesOffset = align(sizeof(header) + sizeof(uint64_t) * _numLevels);
+        header.idxsOffset = align(header.nodesOffset + sizeof(BoxT<T>) * _numNodes);
+
+        uint64_t written = 0;
+        auto write = [&](const void* data, uint64_t size) {
+            os.write(static_cast<const char*>(data), size);
+            written += size;
+        };
+        auto pad = [&](uint64_t target) {
+            static const char zeros[geoFileAlignment] = {};
+            write(zeros, target - written);
+        };
+        write(&header, sizeof(header));
+        write(_levelEnds, sizeof(uint64_t) * _numLevels);
+        pad(header.nodesOffset);
+        write(_nodes, sizeof(BoxT<T>) * _numNodes);
+        pad(header.idxsOffset);
+        write(_idxs, sizeof(int32_t) * _numNodes);
+        return static_cast<bool>(os);
+    }
+    bool Write(const std::string& path) const {
+        std::ofstream ofs(path, std::ios::binary);
+        return ofs && Write(ofs) && ofs.flush();
+    }
+
+    // map a file written by Write() read-only, false if it is missing, malformed, or of another coordinate type
+    // The level ends and the child/box references of all nodes are checked once, so queries stay in bounds.
+    bool Open(const std::string& path) {
+        Clear();
+        if (!_file.Open(path)) return false;
+        if (!Parse()) {
+            Clear();
+            return false;
+        }
+        return true;
+    }
+
+    // func(boxIdx) for every box intersecting window (closed intersection), boxIdx indexes the boxes built from
+    template <typename Func>
+    void Query(const BoxT<T>& window, const Func& func) const {
+        if (_numNodes == 0 || !_nodes[_numNodes - 1].HasIntersectWith(window)) return;
+        std::vector<std::pair<uint64_t, uint32_t>> stack = {{_numNodes - 1, _numLevels - 1}};  // (node, level)
+        while (!stack.empty()) {
+            auto node = stack.back();
+            stack.pop_back();
+            if (node.second == 0) {
+                func(_idxs[node.first]);
+                continue;
+            }
+            uint64_t begin = _idxs[node.first];
+            uint64_t end = std::min<uint64_t>(begin + _nodeSize, _levelEnds[node.second - 1]);
+            for (uint64_t child = begin; child < end; ++child) {
+                if (_nodes[child].HasIntersectWith(window)) stack.emplace_back(child, node.second - 1);
+            }
+        }
+    }
+    std::vector<int> Query(const BoxT<T>& window) const {
+        std::vector<int> idxs;
+        Query(window, [&](int i) { idxs.push_back(i); });
+        return idxs;
+    }
+
+    size_t size() const { return _numItems; }
+    bool empty() const { return _numItems == 0; }
+    bool IsMapped() const { return _file.IsOpen(); }
+    BoxT<T> bound() const { return _numNodes > 0 ? _nodes[_numNodes - 1] : BoxT<T>(); }
+
+    static constexpr uint32_t version = 2;
+
+private:
+    // either owned storage (Build) or the mapped file (Open)
+    std::vector<BoxT<T>> _nodeStore;
+    std::vector<int32_t> _idxStore;  // item index for leaves, position of the first child otherwise
+    std::vector<uint64_t> _levelEndStore;
+    MappedFile _file;
+
+    const BoxT<T>* _nodes = nullptr;
+    const int32_t* _idxs = nullptr;
+    const uint64_t* _levelEnds = nullptr;  // end position of each level, leaves first
+    uint64_t _numItems = 0, _numNodes = 0;
+    uint32_t _numLevels = 0, _numBoxes = 0, _nodeSize = 16;
+
+    void Clear() {
+        _file.Close();
+        _nodeStore.clear();
+        _idxStore.clear();
+        _levelEndStore.clear();
+        _nodes = nullptr;
+        _idxs = nullptr;
+        _levelEnds = nullptr;
+        _numItems = _numNodes = 0;
+        _numLevels = _numBoxes = 0;
+    }
+
+    bool Parse() {
+        if (_file.size() < sizeof(PackedRTreeHeader)) return false;
+        PackedRTreeHeader header;
+        std::memcpy(&header, _file.data(), sizeof(header));
+        if (std::memcmp(header.magic, "UTILSRTR", 8) != 0 || header.endianMark != geoFileEndianMark ||
+            header.version != version || header.coordType != GeoCoordType<T>::value || header.nodeSize < 2) {
+            return false;
+        }
+        uint64_t size = _file.size();
+        if (header.numLevels > 64 || sizeof(header) + sizeof(uint64_t) * header.numLevels > size ||
+            header.nodesOffset % geoFileAlignment != 0 || header.idxsOffset % geoFileAlignment != 0 ||
+            header.nodesOffset > size || (size - header.nodesOffset) / sizeof(BoxT<T>) < header.numNodes ||
+            header.idxsOffset > size || (size - header.idxsOffset) / sizeof(int32_t) < header.numNodes) {
+            return false;
+        }
+        _levelEnds = reinterpret_cast<const uint64_t*>(_file.data() + sizeof(header));
+        _nodes = reinterpret_cast<const BoxT<T>*>(_file.data() + header.nodesOffset);
+        _idxs = reinterpret_cast<const int32_t*>(_file.data() + header.idxsOffset);
+        if ((header.numNodes == 0) != (header.numLevels == 0) || header.numItems > header.numBoxes) return false;
+        // levels: leaves first, strictly increasing ends, a single root
+        for (uint32_t level = 0; level < header.numLevels; ++level) {
+            uint64_t begin = level == 0 ? 0 : _levelEnds[level - 1];
+            if (_levelEnds[level] <= begin) return false;
+        }
+        if (header.numLevels > 0 &&
+            (_levelEnds[0] != header.numItems || _levelEnds[header.numLevels - 1] != header.numNodes ||
+             _levelEnds[header.numLevels - 1] - (header.numLevels > 1 ? _levelEnds[header.numLevels - 2] : 0) != 1)) {
+            return false;
+        }
+        // leaves refer to boxes, other nodes to the first of their children in the level below
+        for (uint64_t k = 0; k < header.numItems; ++k) {
+            if (_idxs[k] < 0 || static_cast<uint64_t>(_idxs[k]) >= header.numBoxes) return false;
+        }
+        for (uint32_t level = 1; level < header.numLevels; ++level) {
+            uint64_t childBegin = level == 1 ? 0 : _levelEnds[level - 2], childEnd = _levelEnds[level - 1];
+            for (uint64_t k = childEnd; k < _levelEnds[level]; ++k) {
+                if (_idxs[k] < 0 || static_cast<uint64_t>(_idxs[k]) < childBegin ||
+                    static_cast<uint64_t>(_idxs[k]) >= childEnd) {
+                    return false;
+                }
+            }
+        }
+        _numItems = header.numItems;
+        _numNodes = header.numNodes;
+        _numLevels = header.numLevels;
+        _numBoxes = header.numBoxes;
+        _nodeSize = header.nodeSize;
+        return true;
+    }
+};
+
+}  // namespace utils
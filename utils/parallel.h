@@ -0,0 +1,102 @@
+//
+// Light-weight multi-threading helpers (std::thread based)
+// 1. "ParallelFor(begin, end, func)" calls func(i) for every i in [begin, end) with dynamic scheduling
+// 2. "ParallelForRange(begin, end, func)" calls func(threadIdx, lo, hi) on one contiguous range per thread,
+//     which is handy for per-thread output buffers
+// 3. "ParallelSort(begin, end, cmp)" sorts one range per thread and merges them pairwise in parallel rounds
+//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace utils {
+
+// number of worker threads to use (numThreads <= 0 means all hardware threads)
+inline int GetNumThreads(int numThreads = 0) {
+    if (numThreads > 0) return numThreads;
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+// func(threadIdx, lo, hi) on [begin, end) split into (at most) numThreads contiguous ranges
+template <typename Func>
+void ParallelForRange(size_t begin, size_t end, const Func& func, int numThreads = 0) {
+    if (begin >= end) return;
+    size_t num = end - begin;
+    size_t numRanges = std::min(static_cast<size_t>(GetNumThreads(numThreads)), num);
+    if (numRanges <= 1) {
+        func(0, begin, end);
+        return;
+    }
+    std::vector<std::thread> threads;
+    threads.reserve(numRanges - 1);
+    for (size_t t = 1; t < numRanges; ++t) {
+        threads.emplace_back([&, t]() {
+            func(static_cast<int>(t), begin + num * t / numRanges, begin + num * (t + 1) / numRanges);
+        });
+    }
+    func(0, begin, begin + num / numRanges);
+    for (auto& thread : threads) thread.join();
+}
+
+// func(i) for i in [begin, end) with dynamic scheduling in chunks of grainSize
+template <typename Func>
+void ParallelFor(size_t begin, size_t end, const Func& func, int numThreads = 0, size_t grainSize = 1024) {
+    if (begin >= end) return;
+    grainSize = std::max<size_t>(grainSize, 1);
+    size_t numChunks = (end - begin + grainSize - 1) / grainSize;
+    numThreads = static_cast<int>(std::min(static_cast<size_t>(GetNumThreads(numThreads)), numChunks));
+    if (numThreads <= 1) {
+        for (size_t i = begin; i < end; ++i) func(i);
+        return;
+    }
+    std::atomic<size_t> nextChunk(0);
+    auto worker = [&]() {
+        for (size_t chunk = nextChunk++; chunk < numChunks; chunk = nextChunk++) {
+            size_t lo = begin + chunk * grainSize;
+            size_t hi = std::min(end, lo + grainSize);
+            for (size_t i = lo; i < hi; ++i) func(i);
+        }
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads - 1);
+    for (int t = 1; t < numThreads; ++t) threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads) thread.join();
+}
+
+// Sort [begin, end) with cmp (not stable), serial for small inputs
+template <typename RandomIt, typename Compare>
+void ParallelSort(RandomIt begin, RandomIt end, const Compare& cmp, int numThreads = 0, size_t minRangeSize = 1 << 14) {
+    size_t num = end - begin;
+    size_t numRanges = std::min<size_t>(GetNumThreads(numThreads), num / std::max<size_t>(minRangeSize, 1));
+    if (numRanges <= 1) {
+        std::sort(begin, end, cmp);
+        return;
+    }
+    std::vector<size_t> bounds(numRanges + 1);
+    for (size_t i = 0; i <= numRanges; ++i) bounds[i] = num * i / numRanges;
+    ParallelFor(
+        0,
+        numRanges,
+        [&](size_t i) { std::sort(begin + bounds[i], begin + bounds[i + 1], cmp); },
+        static_cast<int>(numRanges),
+        1);
+    for (size_t width = 1; width < numRanges; width *= 2) {
+        ParallelFor(
+            0,
+            (numRanges + 2 * width - 1) / (2 * width),
+            [&](size_t k) {
+                size_t lo = 2 * width * k;
+                size_t mid = std::min(lo + width, numRanges), hi = std::min(lo + 2 * width, numRanges);
+                if (mid < hi) std::inplace_merge(begin + bounds[lo], begin + bounds[mid], begin + bounds[hi], cmp);
+            },
+            static_cast<int>(numRanges),
+            1);
+    }
+}
+
+}  // namespace utils
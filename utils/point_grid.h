@@ -0,0 +1,170 @@
+//
+// Uniform grid over a static point set for fixed-radius neighborhood search
+// Only non-empty cells are stored (sorted by row then column), so memory is O(#points) regardless of the extent.
+// Points within cellSize (under any of L-1/L-2/L-inf) of a point lie in its 3x3 block of cells.
+// NeighborGraph builds the fixed-radius near-neighbor graph (all pairs within a distance) on a grid of that size.
+//
+
+#pragma once
+
+#include <cmath>
+#include <numeric>
+
+#include "geo.h"
+#include "parallel.h"
+
+namespace utils {
+
+template <typename T>
+class PointGridT {
+public:
+    struct Cell {
+        long long cx, cy;  // cell coordinates
+        int begin, end;    // range in pointIdxs()
+    };
+
+    PointGridT() = default;
+    PointGridT(const std::vector<PointT<T>>& points, T cellSize) { Build(points, cellSize); }
+
+    void Build(const std::vector<PointT<T>>& points, T cellSize) {
+        _cellSize = cellSize > 0 ? static_cast<double>(cellSize) : 1.0;
+        _cells.clear();
+        _pointIdxs.resize(points.size());
+        if (points.empty()) return;
+        _origin = points[0];
+        for (const auto& pt : points) {
+            _origin.x = std::min(_origin.x, pt.x);
+            _origin.y = std::min(_origin.y, pt.y);
+        }
+
+        // sort points by cell
+        std::vector<std::pair<long long, long long>> keys(points.size());
+        for (size_t i = 0; i < points.size(); ++i) keys[i] = GetCellOf(points[i]);
+        std::iota(_pointIdxs.begin(), _pointIdxs.end(), 0);
+        std::sort(_pointIdxs.begin(), _pointIdxs.end(), [&](int lhs, int rhs) {
+            return keys[lhs].second < keys[rhs].second ||
+                   (keys[lhs].second == keys[rhs].second && keys[lhs].first < keys[rhs].first);
+        });
+
+        // group into cells
+        for (int i = 0; i < static_cast<int>(_pointIdxs.size()); ++i) {
+            const auto& key = keys[_pointIdxs[i]];
+            if (_cells.empty() || _cells.back().cx != key.first || _cells.back().cy != key.second) {
+                _cells.push_back({key.first, key.second, i, i});
+            }
+            _cells.back().end = i + 1;
+        }
+    }
+
+    // Getters
+    size_t numCells() const { return _cells.size(); }
+    const Cell& cell(int i) const { return _cells[i]; }
+    const std::vector<int>& pointIdxs() const { return _pointIdxs; }  // point indices grouped by cell
+    double cellSize() const { return _cellSize; }
+
+    // cell coordinates (column, row) of an arbitrary location
+    std::pair<long long, long long> GetCellOf(const PointT<T>& pt) const {
+        return {static_cast<long long>(std::floor((static_cast<double>(pt.x) - _origin.x) / _cellSize)),
+                static_cast<long long>(std::floor((static_cast<double>(pt.y) - _origin.y) / _cellSize))};
+    }
+
+    // func(cellIdx) for every non-empty cell in the 3x3 block around cell coordinates (cx, cy)
+    template <typename Func>
+    void ForEachNeighborCell(long long cx, long long cy, const Func& func) const {
+        for (long long y = cy - 1; y <= cy + 1; ++y) {
+            auto it = std::lower_bound(_cells.begin(), _cells.end(), y, [&](const Cell& c, long long row) {
+                return c.cy < row || (c.cy == row && c.cx < cx - 1);
+            });
+            for (; it != _cells.end() && it->cy == y && it->cx <= cx + 1; ++it) {
+                func(static_cast<int>(it - _cells.begin()));
+            }
+        }
+    }
+    template <typename Func>
+    void ForEachNeighborCell(int cellIdx, const Func& func) const {
+        ForEachNeighborCell(_cells[cellIdx].cx, _cells[cellIdx].cy, func);
+    }
+
+    // func(pointIdx) for every point in the 3x3 block around pt (a superset of the points within cellSize)
+    template <typename Func>
+    void ForEachCandidate(const PointT<T>& pt, const Func& func) const {
+        if (_cells.empty()) return;
+        auto key = GetCellOf(pt);
+        ForEachNeighborCell(key.first, key.second, [&](int c) {
+            for (int i = _cells[c].begin; i < _cells[c].end; ++i) func(_pointIdxs[i]);
+        });
+    }
+
+private:
+    double _cellSize = 1.0;
+    PointT<T> _origin;
+    std::vector<Cell> _cells;
+    std::vector<int> _pointIdxs;
+};
+
+// Neighbors of every point within radius (inclusive) under metric, as CSR: the neighbors of point i are
+// neighbors[begins[i], begins[i + 1]) in ascending order (i itself excluded, so the graph is symmetric)
+// Each thread searches a contiguous range of points in grid order into its own buffer; the degrees are known once all
+// threads are done, so neighbors is allocated once and the buffers are copied into place in parallel.
+template <typename T>
+void NeighborGraph(const std::vector<PointT<T>>& points,
+                   T radius,
+                   DistMetric metric,
+                   std::vector<int>& begins,
+                   std::vector<int>& neighbors,
+                   int numThreads = 0) {
+    int numPts = points.size();
+    begins.assign(numPts + 1, 0);
+    neighbors.clear();
+    if (numPts == 0) return;
+    PointGridT<T> grid(points, radius);
+    const auto& idxs = grid.pointIdxs();
+    std::vector<std::vector<int>> buffers(GetNumThreads(numThreads));
+    ParallelForRange(
+        0,
+        numPts,
+        [&](int t, size_t lo, size_t hi) {
+            auto& buffer = buffers[t];
+            // first cell holding position lo of the grid order
+            int c = 0, numCells = grid.numCells();
+            for (int step = 1 << 30; step > 0; step >>= 1) {
+                if (c + step < numCells && grid.cell(c + step).begin <= static_cast<int>(lo)) c += step;
+            }
+            std::vector<int> nearCells;  // the 3x3 block of cell c
+            grid.ForEachNeighborCell(c, [&](int nc) { nearCells.push_back(nc); });
+            for (size_t pos = lo; pos < hi; ++pos) {
+                if (static_cast<int>(pos) >= grid.cell(c).end) {
+                    nearCells.clear();
+                    grid.ForEachNeighborCell(++c, [&](int nc) { nearCells.push_back(nc); });
+                }
+                int i = idxs[pos];
+                size_t begin = buffer.size();
+                for (int nc : nearCells) {
+                    for (int k = grid.cell(nc).begin; k < grid.cell(nc).end; ++k) {
+                        int j = idxs[k];
+                        if (j != i && IsWithinDist(points[i], points[j], radius, metric)) buffer.push_back(j);
+                    }
+                }
+                std::sort(buffer.begin() + begin, buffer.end());
+                begins[i + 1] = buffer.size() - begin;
+            }
+        },
+        numThreads);
+    for (int i = 0; i < numPts; ++i) begins[i + 1] += begins[i];
+    neighbors.resize(begins[numPts]);
+    ParallelForRange(
+        0,
+        numPts,
+        [&](int t, size_t lo, size_t hi) {
+            const int* src = buffers[t].data();
+            for (size_t pos = lo; pos < hi; ++pos) {
+                int i = idxs[pos];
+                std::copy(src, src + (begins[i + 1] - begins[i]), neighbors.begin() + begins[i]);
+                src += begins[i + 1] - begins[i];
+            }
+            std::vector<int>().swap(buffers[t]);
+        },
+        numThreads);
+}
+
+}  // namespace utils
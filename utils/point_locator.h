@@ -0,0 +1,151 @@
+//
+// Point location in the union of a static box set ("is this point covered by any box?")
+// A segment tree over the x locations of the boxes stores every box in the O(log n) nodes whose x ranges it spans,
+// as disjoint sorted y runs (the union of the y intervals stored in a node). A query finds its leaf through a uniform x
+// bucket table and walks up to the root with one binary search per non-empty node, in O(log^2 n).
+//
+// Usage:
+//     PointLocatorT<int> locator(blockages);
+//     if (locator.Contains({x, y})) ...;
+//
+
+#pragma once
+
+#include <numeric>
+
+#include "geo.h"
+#include "parallel.h"
+
+namespace utils {
+
+template <typename T>
+class PointLocatorT {
+public:
+    PointLocatorT() = default;
+    explicit PointLocatorT(const std::vector<BoxT<T>>& boxes) { Build(boxes); }
+
+    // invalid boxes are skipped, degenerated ones (lines, points) are kept
+    void Build(const std::vector<BoxT<T>>& boxes) {
+        _xs.clear();
+        _bound.Set();
+        for (const auto& box : boxes) {
+            if (!box.IsValid()) continue;
+            _xs.push_back(box.lx());
+            _xs.push_back(box.hx());
+            _bound = _bound.UnionWith(box);
+        }
+        std::sort(_xs.begin(), _xs.end());
+        _xs.erase(std::unique(_xs.begin(), _xs.end()), _xs.end());
+        InitBuckets();
+
+        // leaves are the locations (2i) and the open ranges between them (2i + 1), so boxes stay closed
+        _numLeaves = 1;
+        while (_numLeaves < 2 * _xs.size()) _numLeaves *= 2;
+        std::vector<std::pair<size_t, IntervalT<T>>> entries;  // (node, y interval)
+        for (const auto& box : boxes) {
+            if (!box.IsValid()) continue;
+            size_t l = GetLeaf(box.lx()) + _numLeaves, r = GetLeaf(box.hx()) + _numLeaves + 1;
+            for (; l < r; l /= 2, r /= 2) {
+                if (l & 1) entries.emplace_back(l++, box.y);
+                if (r & 1) entries.emplace_back(--r, box.y);
+            }
+        }
+        std::sort(entries.begin(), entries.end(), [](const auto& lhs, const auto& rhs) {
+            return lhs.first < rhs.first || (lhs.first == rhs.first && lhs.second.low < rhs.second.low);
+        });
+
+        // merge the runs of each node (CSR storage)
+        _runs.clear();
+        _nodeBegins.assign(2 * _numLeaves + 1, 0);
+        for (size_t i = 0; i < entries.size();) {
+            size_t node = entries[i].first;
+            for (; i < entries.size() && entries[i].first == node; ++i) {
+                const auto& y = entries[i].second;
+                if (_nodeBegins[node + 1] > 0 && y.low <= _runs.back().high) {
+                    _runs.back().high = std::max(_runs.back().high, y.high);
+                } else {
+                    _runs.push_back(y);
+                    ++_nodeBegins[node + 1];
+                }
+            }
+        }
+        std::partial_sum(_nodeBegins.begin(), _nodeBegins.end(), _nodeBegins.begin());
+    }
+
+    // whether pt is covered by a box (closed boxes)
+    // The nodes on the path are known from the leaf alone, so their memory accesses overlap.
+    bool Contains(const PointT<T>& pt) const {
+        if (!_bound.y.Contain(pt.y)) return false;
+        size_t leaf = GetLeaf(pt.x);
+        if (leaf == npos) return false;
+        for (size_t node = leaf + _numLeaves; node > 0; node /= 2) {
+            int begin = _nodeBegins[node], num = _nodeBegins[node + 1] - begin;
+            if (num == 0) continue;
+            // the last run starting at or below y (branch-free binary search)
+            const IntervalT<T>* run = &_runs[begin];
+            for (; num > 1; num -= num / 2) run = run[num / 2].low <= pt.y ? run + num / 2 : run;
+            if (run->low <= pt.y && pt.y <= run->high) return true;
+        }
+        return false;
+    }
+    // one flag per point; points are visited in x order (counting sort by x bucket) so that consecutive queries share
+    // their tree paths
+    std::vector<char> BatchContains(const std::vector<PointT<T>>& pts, int numThreads = 0) const {
+        std::vector<char> flags(pts.size(), false);
+        std::vector<int> order;
+        if (!_xs.empty()) {
+            std::vector<int> bucketBegins(_xBuckets.size(), 0);
+            for (const auto& pt : pts) {
+                if (_bound.x.Contain(pt.x)) ++bucketBegins[GetBucket(pt.x) + 1];
+            }
+            std::partial_sum(bucketBegins.begin(), bucketBegins.end(), bucketBegins.begin());
+            order.resize(bucketBegins.back());
+            for (int i = 0; i < static_cast<int>(pts.size()); ++i) {
+                if (_bound.x.Contain(pts[i].x)) order[bucketBegins[GetBucket(pts[i].x)]++] = i;
+            }
+        }
+        ParallelFor(
+            0, order.size(), [&](size_t i) { flags[order[i]] = Contains(pts[order[i]]); }, numThreads, 4096);
+        return flags;
+    }
+
+    bool empty() const { return _runs.empty(); }
+    size_t numRuns() const { return _runs.size(); }  // merged y runs over all nodes (memory footprint)
+    const BoxT<T>& bound() const { return _bound; }
+
+private:
+    std::vector<T> _xs;          // sorted unique x locations of the boxes
+    std::vector<int> _xBuckets;  // xs of bucket b (uniform in x) are [_xBuckets[b], _xBuckets[b + 1])
+    double _bucketScale = 0;
+    size_t _numLeaves = 1;         // power of two, node i has children 2i and 2i + 1, leaf j is node _numLeaves + j
+    std::vector<int> _nodeBegins;  // runs of node i are [_nodeBegins[i], _nodeBegins[i + 1])
+    std::vector<IntervalT<T>> _runs;
+    BoxT<T> _bound;
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+    // bucket of x (monotone in x, clamped to the first and last buckets)
+    size_t GetBucket(T x) const {
+        double offset = (static_cast<double>(x) - _xs.front()) * _bucketScale;
+        if (!(offset > 0)) return 0;
+        return std::min(static_cast<size_t>(std::min<double>(offset, _xBuckets.size())), _xBuckets.size() - 2);
+    }
+    void InitBuckets() {
+        size_t numBuckets = std::max<size_t>(_xs.size(), 1);
+        double range = _xs.empty() ? 0 : static_cast<double>(_xs.back()) - _xs.front();
+        _bucketScale = range > 0 ? numBuckets / range : 0;
+        _xBuckets.assign(numBuckets + 1, _xs.size());
+        for (size_t i = _xs.size(); i-- > 0;) _xBuckets[GetBucket(_xs[i])] = i;
+        for (size_t b = numBuckets; b-- > 0;) _xBuckets[b] = std::min(_xBuckets[b], _xBuckets[b + 1]);
+    }
+    // leaf of x, npos if x is out of the bound
+    // x is searched only among the xs of its bucket, as all smaller (larger) buckets hold smaller (larger) xs
+    size_t GetLeaf(T x) const {
+        if (_xs.empty() || !(_xs.front() <= x && x <= _xs.back())) return npos;
+        size_t bucket = GetBucket(x);
+        auto begin = _xs.begin() + _xBuckets[bucket], end = _xs.begin() + _xBuckets[bucket + 1];
+        size_t i = std::lower_bound(begin, end, x) - _xs.begin();
+        return i < _xs.size() && _xs[i] == x ? 2 * i : 2 * i - 1;
+    }
+};
+
+}  // namespace utils
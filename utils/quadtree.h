@@ -0,0 +1,177 @@
+//
+// Region quadtree over a static box set, for highly non-uniform (clustered) distributions
+// A node is split into four quadrants at its center while it holds more than capacity boxes, so the depth adapts
+// to the local density. A box goes down into the quadrant that contains it; boxes spanning a split line stay in the
+// node, unless loose mode is on, where a box goes into the quadrant of its center as long as it is not larger than
+// the quadrant. Every node keeps the bound of all boxes in its subtree, which is what queries prune with.
+// Nodes live in one pool (the four children of a node are contiguous) and the boxes of a node are a range of one
+// index array, so there are no pointers.
+//
+// Usage:
+//     QuadtreeT<int> tree(boxes);
+//     tree.Query(window, [&](int boxIdx) { ... });
+//     int nearest = tree.Nearest(pt);
+//
+
+#pragma once
+
+#include <queue>
+
+#include "geo.h"
+
+namespace utils {
+
+template <typename T>
+class QuadtreeT {
+public:
+    QuadtreeT() = default;
+    QuadtreeT(const std::vector<BoxT<T>>& boxes, int capacity = 16, bool isLoose = false) {
+        Build(boxes, capacity, isLoose);
+    }
+
+    // invalid boxes are skipped
+    void Build(const std::vector<BoxT<T>>& boxes, int capacity = 16, bool isLoose = false) {
+        _boxes = boxes;
+        _capacity = std::max(capacity, 1);
+        _isLoose = isLoose;
+        _nodes.clear();
+        _items.clear();
+        BoxT<T> cell;
+        for (int i = 0; i < static_cast<int>(boxes.size()); ++i) {
+            if (!boxes[i].IsValid()) continue;
+            _items.push_back(i);
+            cell = cell.UnionWith(boxes[i]);
+        }
+        if (_items.empty()) return;
+        _nodes.push_back({cell, cell, -1, 0, static_cast<int>(_items.size())});
+        Split(0, 0);
+    }
+
+    // func(boxIdx) for every box intersecting window (closed intersection)
+    template <typename Func>
+    void Query(const BoxT<T>& window, const Func& func) const {
+        if (_nodes.empty()) return;
+        std::vector<int> stack = {0};
+        while (!stack.empty()) {
+            const Node& node = _nodes[stack.back()];
+            stack.pop_back();
+            if (!node.bound.HasIntersectWith(window)) continue;
+            for (int i = node.itemBegin; i < node.itemEnd; ++i) {
+                if (_boxes[_items[i]].HasIntersectWith(window)) func(_items[i]);
+            }
+            if (node.firstChild >= 0) {
+                for (int child = node.firstChild; child < node.firstChild + 4; ++child) stack.push_back(child);
+            }
+        }
+    }
+    std::vector<int> Query(const BoxT<T>& window) const {
+        std::vector<int> idxs;
+        Query(window, [&](int i) { idxs.push_back(i); });
+        return idxs;
+    }
+
+    // the k boxes nearest to pt by L-1 distance (nearest first, ties in any order)
+    // Best-first search: nodes are expanded in the order of the distance to their subtree bounds.
+    std::vector<int> Nearest(const PointT<T>& pt, int k) const {
+        std::vector<int> idxs;
+        if (_nodes.empty() || k <= 0) return idxs;
+        // (distance, node idx or ~box idx)
+        std::priority_queue<std::pair<T, int>, std::vector<std::pair<T, int>>, std::greater<std::pair<T, int>>> queue;
+        queue.emplace(Dist(_nodes[0].bound, pt), 0);
+        while (!queue.empty() && static_cast<int>(idxs.size()) < k) {
+            int code = queue.top().second;
+            queue.pop();
+            if (code < 0) {
+                idxs.push_back(~code);
+                continue;
+            }
+            const Node& node = _nodes[code];
+            for (int i = node.itemBegin; i < node.itemEnd; ++i) queue.emplace(Dist(_boxes[_items[i]], pt), ~_items[i]);
+            if (node.firstChild >= 0) {
+                for (int child = node.firstChild; child < node.firstChild + 4; ++child) {
+                    if (_nodes[child].bound.IsValid()) queue.emplace(Dist(_nodes[child].bound, pt), child);
+                }
+            }
+        }
+        return idxs;
+    }
+    // -1 if the tree is empty
+    int Nearest(const PointT<T>& pt) const {
+        auto idxs = Nearest(pt, 1);
+        return idxs.empty() ? -1 : idxs[0];
+    }
+
+    size_t size() const { return _items.size(); }
+    bool empty() const { return _items.empty(); }
+    size_t numNodes() const { return _nodes.size(); }
+    BoxT<T> bound() const { return _nodes.empty() ? BoxT<T>() : _nodes[0].bound; }
+
+private:
+    struct Node {
+        BoxT<T> cell;            // region of the node
+        BoxT<T> bound;           // bound of the boxes in the subtree (invalid if none)
+        int firstChild;          // children are [firstChild, firstChild + 4), -1 for a leaf
+        int itemBegin, itemEnd;  // boxes kept in the node are _items[itemBegin, itemEnd)
+    };
+    static constexpr int maxDepth = 32;
+
+    std::vector<BoxT<T>> _boxes;
+    std::vector<Node> _nodes;
+    std::vector<int> _items;  // box indices grouped by node
+    int _capacity = 16;
+    bool _isLoose = false;
+
+    // quadrant (0-3) a box goes into, -1 if it stays in the node
+    int GetQuadrant(const BoxT<T>& box, const BoxT<T>& cell) const {
+        T cx = cell.cx(), cy = cell.cy();
+        if (_isLoose) {
+            if (box.width() > cell.width() / 2 || box.height() > cell.height() / 2) return -1;
+            return (box.cx() > cx ? 1 : 0) + (box.cy() > cy ? 2 : 0);
+        }
+        int qx = box.hx() <= cx ? 0 : (box.lx() >= cx ? 1 : -1);
+        int qy = box.hy() <= cy ? 0 : (box.ly() >= cy ? 2 : -1);
+        return qx < 0 || qy < 0 ? -1 : qx + qy;
+    }
+
+    // split the node recursively while it holds more than _capacity boxes, and compute the subtree bounds
+    void Split(int nodeIdx, int depth) {
+        Node node = _nodes[nodeIdx];
+        node.bound.Set();
+        int num = node.itemEnd - node.itemBegin;
+        T cx = node.cell.cx(), cy = node.cell.cy();
+        bool canSplit = num > _capacity && depth < maxDepth && (cx != node.cell.lx() || cy != node.cell.ly());
+        if (canSplit) {
+            // group the items by quadrant, the kept ones (-1) first
+            std::vector<int> quadrants(num), groupBegins(6, 0), items(num);
+            for (int i = 0; i < num; ++i) {
+                quadrants[i] = GetQuadrant(_boxes[_items[node.itemBegin + i]], node.cell);
+                ++groupBegins[quadrants[i] + 2];
+            }
+            canSplit = groupBegins[1] < num;
+            if (canSplit) {
+                for (int q = 0; q < 5; ++q) groupBegins[q + 1] += groupBegins[q];
+                std::vector<int> groupEnds = groupBegins;
+                for (int i = 0; i < num; ++i) items[groupEnds[quadrants[i] + 1]++] = _items[node.itemBegin + i];
+                std::copy(items.begin(), items.end(), _items.begin() + node.itemBegin);
+                node.firstChild = _nodes.size();
+                for (int q = 0; q < 4; ++q) {
+                    BoxT<T> cell((q & 1) ? cx : node.cell.lx(),
+                                 (q & 2) ? cy : node.cell.ly(),
+                                 (q & 1) ? node.cell.hx() : cx,
+                                 (q & 2) ? node.cell.hy() : cy);
+                    int itemBegin = node.itemBegin + groupBegins[q + 1], itemEnd = node.itemBegin + groupBegins[q + 2];
+                    _nodes.push_back({cell, BoxT<T>(), -1, itemBegin, itemEnd});
+                }
+                node.itemEnd = node.itemBegin + groupBegins[1];
+                for (int child = node.firstChild; child < node.firstChild + 4; ++child) {
+                    Split(child, depth + 1);
+                    node.bound = node.bound.UnionWith(_nodes[child].bound);
+                }
+            }
+        }
+        for (int i = node.itemBegin; i < node.itemEnd; ++i) node.bound = node.bound.UnionWith(_boxes[_items[i]]);
+        _nodes[nodeIdx] = node;
+    }
+};
+
+}  // namespace utils
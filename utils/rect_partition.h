@@ -0,0 +1,447 @@
+//
+// Partition of rectilinear polygons (given as box sets) into rectangles
+// Same in/out convention as SlicePolygons: the boxes are replaced by the partition of their union.
+// 1. PartitionMode::Minimum: minimum number of rectangles by the chord method. Good chords (axis-parallel chords
+//     between two reflex vertices) form a bipartite intersection graph (horizontal vs vertical); a maximum independent
+//     set of chords (via maximum matching & Koenig's theorem) is cut first, and every remaining reflex vertex is
+//     resolved by one vertical cut.
+// 2. PartitionMode::Greedy: the better of the vertical and horizontal slab decompositions of the union, O(n log n).
+//
+
+#pragma once
+
+#include <queue>
+
+#include "box_index.h"
+#include "box_set.h"
+#include "union_find.h"
+
+namespace utils {
+
+enum class PartitionMode { Minimum, Greedy };
+
+// Minimum rectangle partition of disjoint boxes with integer (rank) coordinates
+class MinRectPartitioner {
+public:
+    std::vector<BoxT<int>> Run(const std::vector<BoxT<int>>& boxes) {
+        _boxes = boxes;
+        _index.Build(_boxes);
+        for (int d = 0; d < 2; ++d) _cuts[d].clear();
+
+        // 1. reflex vertices & good chords
+        FindReflexVertices();
+        std::vector<Chord> chords[2];
+        for (int d = 0; d < 2; ++d) FindGoodChords(d, chords[d]);
+
+        // 2. maximum independent set of chords as cuts
+        std::vector<char> isChosen[2];
+        ChooseChords(chords, isChosen);
+        std::vector<char> resolved(_reflexVertices.size(), false);
+        for (int d = 0; d < 2; ++d) {
+            for (size_t i = 0; i < chords[d].size(); ++i) {
+                if (!isChosen[d][i]) continue;
+                _cuts[d].push_back(chords[d][i]);
+                resolved[chords[d][i].vertex1] = resolved[chords[d][i].vertex2] = true;
+            }
+        }
+
+        // 3. vertical cut from each unresolved reflex vertex
+        MergeCuts(_cuts[0]);
+        for (size_t i = 0; i < _reflexVertices.size(); ++i) {
+            if (!resolved[i]) _cuts[1].push_back(ShootVerticalCut(_reflexVertices[i]));
+        }
+        for (int d = 0; d < 2; ++d) MergeCuts(_cuts[d]);
+
+        // 4. pieces: split boxes along the cuts and connect neighbors not separated by a cut
+        return CollectPieces();
+    }
+
+private:
+    struct Vertex {
+        int x, y;
+        int dirs[2];  // interior direction (+1/-1) of the chord along x/y from it
+    };
+    struct Chord {  // along dir d: coordinate d ranges in [lo, hi], coordinate 1 - d is pos
+        int pos, lo, hi;
+        int vertex1, vertex2;
+    };
+
+    std::vector<BoxT<int>> _boxes;
+    BoxGridIndexT<int> _index;
+    std::vector<Vertex> _reflexVertices;
+    std::vector<Chord> _cuts[2];
+
+    // whether the quadrant (sx, sy) (0 for -, 1 for +) of point (x, y) is interior
+    bool IsInteriorQuadrant(int x, int y, int sx, int sy, const std::vector<int>& nearBoxes) const {
+        for (int i : nearBoxes) {
+            const auto& box = _boxes[i];
+            if ((sx ? box.lx() <= x && x < box.hx() : box.lx() < x && x <= box.hx()) &&
+                (sy ? box.ly() <= y && y < box.hy() : box.ly() < y && y <= box.hy())) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void FindReflexVertices() {
+        // polygon vertices are corners of the disjoint boxes
+        std::vector<std::pair<int, int>> corners;
+        for (const auto& box : _boxes) {
+            for (int x : {box.lx(), box.hx()}) {
+                for (int y : {box.ly(), box.hy()}) corners.emplace_back(x, y);
+            }
+        }
+        std::sort(corners.begin(), corners.end());
+        corners.erase(std::unique(corners.begin(), corners.end()), corners.end());
+        _reflexVertices.clear();
+        std::vector<int> nearBoxes;
+        for (const auto& corner : corners) {
+            nearBoxes.clear();
+            _index.Query(BoxT<int>(corner.first, corner.second), [&](int i) { nearBoxes.push_back(i); });
+            int numInterior = 0, missingX = 0, missingY = 0;
+            for (int sx = 0; sx < 2; ++sx) {
+                for (int sy = 0; sy < 2; ++sy) {
+                    if (IsInteriorQuadrant(corner.first, corner.second, sx, sy, nearBoxes)) {
+                        ++numInterior;
+                    } else {
+                        missingX = sx;
+                        missingY = sy;
+                    }
+                }
+            }
+            if (numInterior == 3) {
+                _reflexVertices.push_back({corner.first, corner.second, {missingX ? -1 : 1, missingY ? -1 : 1}});
+            }
+        }
+    }
+
+    // whether the open segment along d at pos over (lo, hi) is interior (covered on both sides)
+    bool IsInteriorSegment(int d, int pos, int lo, int hi) const {
+        BoxT<int> window;
+        window[d].Set(lo, hi);
+        window[1 - d].Set(pos);
+        std::vector<IntervalT<int>> sides[2];
+        _index.Query(window, [&](int i) {
+            const auto& box = _boxes[i];
+            if (box[1 - d].low <= pos && pos < box[1 - d].high) sides[1].push_back(box[d]);
+            if (box[1 - d].low < pos && pos <= box[1 - d].high) sides[0].push_back(box[d]);
+        });
+        for (auto& side : sides) {
+            std::sort(side.begin(), side.end(), [](const IntervalT<int>& lhs, const IntervalT<int>& rhs) {
+                return lhs.low < rhs.low;
+            });
+            int covered = lo;
+            for (const auto& intvl : side) {
+                if (intvl.low > covered) break;
+                covered = std::max(covered, intvl.high);
+            }
+            if (covered < hi) return false;
+        }
+        return true;
+    }
+
+    // chords along d between consecutive reflex vertices on the same line
+    void FindGoodChords(int d, std::vector<Chord>& chords) const {
+        std::vector<int> order(_reflexVertices.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+        auto coord = [&](int i, int dim) { return dim == 0 ? _reflexVertices[i].x : _reflexVertices[i].y; };
+        std::sort(order.begin(), order.end(), [&](int lhs, int rhs) {
+            return std::make_pair(coord(lhs, 1 - d), coord(lhs, d)) < std::make_pair(coord(rhs, 1 - d), coord(rhs, d));
+        });
+        for (size_t k = 0; k + 1 < order.size(); ++k) {
+            int u = order[k], v = order[k + 1];
+            if (coord(u, 1 - d) != coord(v, 1 - d)) continue;
+            if (_reflexVertices[u].dirs[d] != 1 || _reflexVertices[v].dirs[d] != -1) continue;
+            if (!IsInteriorSegment(d, coord(u, 1 - d), coord(u, d), coord(v, d))) continue;
+            chords.push_back({coord(u, 1 - d), coord(u, d), coord(v, d), u, v});
+        }
+    }
+
+    // maximum independent set of the bipartite intersection graph (Hopcroft-Karp + Koenig)
+    void ChooseChords(const std::vector<Chord> chords[2], std::vector<char> isChosen[2]) const {
+        const auto& hChords = chords[0];
+        const auto& vChords = chords[1];
+        std::vector<int> vOrder(vChords.size());
+        for (size_t i = 0; i < vOrder.size(); ++i) vOrder[i] = i;
+        std::sort(vOrder.begin(), vOrder.end(), [&](int lhs, int rhs) { return vChords[lhs].pos < vChords[rhs].pos; });
+        std::vector<std::vector<int>> adj(hChords.size());
+        for (size_t h = 0; h < hChords.size(); ++h) {
+            auto it = std::lower_bound(vOrder.begin(), vOrder.end(), hChords[h].lo, [&](int v, int val) {
+                return vChords[v].pos < val;
+            });
+            for (; it != vOrder.end() && vChords[*it].pos <= hChords[h].hi; ++it) {
+                if (vChords[*it].lo <= hChords[h].pos && hChords[h].pos <= vChords[*it].hi) adj[h].push_back(*it);
+            }
+        }
+
+        // Hopcroft-Karp
+        int numH = hChords.size(), numV = vChords.size();
+        std::vector<int> matchH(numH, -1), matchV(numV, -1), dist(numH), iters(numH);
+        while (true) {
+            std::queue<int> bfs;
+            for (int h = 0; h < numH; ++h) {
+                dist[h] = matchH[h] == -1 ? 0 : -1;
+                if (matchH[h] == -1) bfs.push(h);
+            }
+            bool hasAugmenting = false;
+            while (!bfs.empty()) {
+                int h = bfs.front();
+                bfs.pop();
+                for (int v : adj[h]) {
+                    int next = matchV[v];
+                    if (next == -1) {
+                        hasAugmenting = true;
+                    } else if (dist[next] == -1) {
+                        dist[next] = dist[h] + 1;
+                        bfs.push(next);
+                    }
+                }
+            }
+            if (!hasAugmenting) break;
+            std::fill(iters.begin(), iters.end(), 0);
+            for (int root = 0; root < numH; ++root) {
+                if (matchH[root] != -1) continue;
+                // iterative DFS along the layered graph
+                std::vector<int> path = {root};
+                while (!path.empty()) {
+                    int h = path.back();
+                    if (iters[h] == static_cast<int>(adj[h].size())) {
+                        dist[h] = -1;  // dead end
+                        path.pop_back();
+                        continue;
+                    }
+                    int v = adj[h][iters[h]++];
+                    int next = matchV[v];
+                    if (next == -1) {  // augment along the path
+                        for (int k = path.size() - 1; k >= 0; --k) {
+                            int hk = path[k], vk = adj[hk][iters[hk] - 1];
+                            matchH[hk] = vk;
+                            matchV[vk] = hk;
+                        }
+                        break;
+                    } else if (dist[next] == dist[h] + 1) {
+                        path.push_back(next);
+                    }
+                }
+            }
+        }
+
+        // Koenig: Z = vertices reachable from free H vertices by alternating paths; MIS = (H & Z) | (V - Z)
+        std::vector<char> reachedH(numH, false), reachedV(numV, false);
+        std::queue<int> bfs;
+        for (int h = 0; h < numH; ++h) {
+            if (matchH[h] == -1) {
+                reachedH[h] = true;
+                bfs.push(h);
+            }
+        }
+        while (!bfs.empty()) {
+            int h = bfs.front();
+            bfs.pop();
+            for (int v : adj[h]) {
+                if (reachedV[v] || matchH[h] == v) continue;
+                reachedV[v] = true;
+                if (matchV[v] != -1 && !reachedH[matchV[v]]) {
+                    reachedH[matchV[v]] = true;
+                    bfs.push(matchV[v]);
+                }
+            }
+        }
+        isChosen[0] = reachedH;
+        isChosen[1].resize(numV);
+        for (int v = 0; v < numV; ++v) isChosen[1][v] = !reachedV[v];
+    }
+
+    // vertical cut from a reflex vertex into the interior until the boundary or a cut along x
+    Chord ShootVerticalCut(const Vertex& vertex) const {
+        int dir = vertex.dirs[1];
+        int limit = dir > 0 ? _index.bound().hy() : _index.bound().ly();
+        BoxT<int> window(vertex.x, std::min(vertex.y, limit), vertex.x, std::max(vertex.y, limit));
+        // extent covered on both sides of the line x = vertex.x
+        std::vector<IntervalT<int>> sides[2];
+        _index.Query(window, [&](int i) {
+            const auto& box = _boxes[i];
+            if (box.lx() <= vertex.x && vertex.x < box.hx()) sides[1].push_back(box.y);
+            if (box.lx() < vertex.x && vertex.x <= box.hx()) sides[0].push_back(box.y);
+        });
+        int end = limit;
+        for (auto& side : sides) {
+            int reach = vertex.y;
+            if (dir > 0) {
+                std::sort(side.begin(), side.end(), [](const IntervalT<int>& lhs, const IntervalT<int>& rhs) {
+                    return lhs.low < rhs.low;
+                });
+                for (const auto& intvl : side) {
+                    if (intvl.low <= reach) reach = std::max(reach, intvl.high);
+                }
+                end = std::min(end, reach);
+            } else {
+                std::sort(side.begin(), side.end(), [](const IntervalT<int>& lhs, const IntervalT<int>& rhs) {
+                    return lhs.high > rhs.high;
+                });
+                for (const auto& intvl : side) {
+                    if (intvl.high >= reach) reach = std::min(reach, intvl.low);
+                }
+                end = std::max(end, reach);
+            }
+        }
+        // stop at the nearest chosen chord along x
+        auto byPos = [](const Chord& cut, int val) { return cut.pos < val; };
+        auto it = std::lower_bound(_cuts[0].begin(), _cuts[0].end(), std::min(vertex.y, end), byPos);
+        for (; it != _cuts[0].end() && it->pos <= std::max(vertex.y, end); ++it) {
+            if (it->lo <= vertex.x && vertex.x <= it->hi && (it->pos - vertex.y) * dir > 0 &&
+                (it->pos - end) * dir < 0) {
+                end = it->pos;
+            }
+        }
+        return {vertex.x, std::min(vertex.y, end), std::max(vertex.y, end), -1, -1};
+    }
+
+    // sort cuts by (pos, lo) and merge overlapping ones on the same line
+    static void MergeCuts(std::vector<Chord>& cuts) {
+        std::sort(cuts.begin(), cuts.end(), [](const Chord& lhs, const Chord& rhs) {
+            return lhs.pos < rhs.pos || (lhs.pos == rhs.pos && lhs.lo < rhs.lo);
+        });
+        std::vector<Chord> merged;
+        for (const auto& cut : cuts) {
+            if (!merged.empty() && merged.back().pos == cut.pos && cut.lo <= merged.back().hi) {
+                merged.back().hi = std::max(merged.back().hi, cut.hi);
+            } else {
+                merged.push_back(cut);
+            }
+        }
+        cuts = move(merged);
+    }
+
+    // whether the segment along d at pos over [lo, hi] lies on a cut
+    bool IsOnCut(int d, int pos, int lo, int hi) const {
+        const auto& cuts = _cuts[d];
+        auto isBefore = [](std::pair<int, int> val, const Chord& cut) { return val < std::make_pair(cut.pos, cut.lo); };
+        auto it = std::upper_bound(cuts.begin(), cuts.end(), std::make_pair(pos, lo), isBefore);
+        return it != cuts.begin() && (--it)->pos == pos && it->hi >= hi;
+    }
+
+    std::vector<BoxT<int>> CollectPieces() const {
+        // split positions of each box
+        std::vector<std::vector<int>> splits[2];
+        for (int d = 0; d < 2; ++d) splits[d].resize(_boxes.size());
+        for (int d = 0; d < 2; ++d) {
+            for (const auto& cut : _cuts[d]) {
+                BoxT<int> window;
+                window[d].Set(cut.lo, cut.hi);
+                window[1 - d].Set(cut.pos);
+                _index.Query(window, [&](int i) {
+                    const auto& box = _boxes[i];
+                    if (!(box[d].low < cut.hi && box[d].high > cut.lo)) return;
+                    if (box[d].StrictlyContain(cut.lo)) splits[d][i].push_back(cut.lo);
+                    if (box[d].StrictlyContain(cut.hi)) splits[d][i].push_back(cut.hi);
+                    if (box[1 - d].StrictlyContain(cut.pos)) splits[1 - d][i].push_back(cut.pos);
+                });
+            }
+        }
+        std::vector<BoxT<int>> subBoxes;
+        for (size_t i = 0; i < _boxes.size(); ++i) {
+            std::vector<int> locs[2];
+            for (int d = 0; d < 2; ++d) {
+                locs[d] = splits[d][i];
+                locs[d].push_back(_boxes[i][d].low);
+                locs[d].push_back(_boxes[i][d].high);
+                std::sort(locs[d].begin(), locs[d].end());
+                locs[d].erase(std::unique(locs[d].begin(), locs[d].end()), locs[d].end());
+            }
+            for (size_t xi = 0; xi + 1 < locs[0].size(); ++xi) {
+                for (size_t yi = 0; yi + 1 < locs[1].size(); ++yi) {
+                    subBoxes.emplace_back(locs[0][xi], locs[1][yi], locs[0][xi + 1], locs[1][yi + 1]);
+                }
+            }
+        }
+
+        // connect neighbors sharing an edge (of positive length) that is not on a cut
+        UnionFind uf(subBoxes.size());
+        for (int d = 0; d < 2; ++d) {  // shared edges along 1 - d, neighbors in d
+            std::vector<std::pair<int, int>> lows, highs;  // (coordinate in d, sub box)
+            for (int i = 0; i < static_cast<int>(subBoxes.size()); ++i) {
+                lows.emplace_back(subBoxes[i][d].low, i);
+                highs.emplace_back(subBoxes[i][d].high, i);
+            }
+            auto byEdge = [&](const std::pair<int, int>& lhs, const std::pair<int, int>& rhs) {
+                return lhs.first < rhs.first ||
+                       (lhs.first == rhs.first && subBoxes[lhs.second][1 - d].low < subBoxes[rhs.second][1 - d].low);
+            };
+            std::sort(lows.begin(), lows.end(), byEdge);
+            std::sort(highs.begin(), highs.end(), byEdge);
+            size_t l = 0;
+            for (size_t h = 0; h < highs.size(); ++h) {
+                int pos = highs[h].first;
+                const auto& intvl = subBoxes[highs[h].second][1 - d];
+                auto isBefore = [&](const std::pair<int, int>& low) {
+                    return low.first < pos || (low.first == pos && subBoxes[low.second][1 - d].high <= intvl.low);
+                };
+                while (l < lows.size() && isBefore(lows[l])) ++l;
+                for (size_t k = l; k < lows.size() && lows[k].first == pos; ++k) {
+                    const auto& other = subBoxes[lows[k].second][1 - d];
+                    if (other.low >= intvl.high) break;
+                    auto shared = intvl.IntersectWith(other);
+                    if (shared.IsStrictValid() && !IsOnCut(1 - d, pos, shared.low, shared.high)) {
+                        uf.Union(highs[h].second, lows[k].second);
+                    }
+                }
+            }
+        }
+
+        // each component is a rectangle
+        std::vector<BoxT<int>> pieces;
+        std::vector<int> pieceOf(subBoxes.size(), -1);
+        for (int i = 0; i < static_cast<int>(subBoxes.size()); ++i) {
+            int& piece = pieceOf[uf.Find(i)];
+            if (piece == -1) {
+                piece = pieces.size();
+                pieces.push_back(subBoxes[i]);
+            } else {
+                pieces[piece] = pieces[piece].UnionWith(subBoxes[i]);
+            }
+        }
+        return pieces;
+    }
+};
+
+// Partition the union of boxes into rectangles (see PartitionMode)
+template <typename T>
+void PartitionPolygons(std::vector<BoxT<T>>& boxes, PartitionMode mode = PartitionMode::Minimum) {
+    auto transpose = [](std::vector<BoxT<T>>& bs) {
+        for (auto& box : bs) box = BoxT<T>(box.y, box.x);
+    };
+    std::vector<BoxT<T>> slabs = UnionBoxes(boxes);
+    if (mode == PartitionMode::Greedy) {
+        transpose(boxes);
+        std::vector<BoxT<T>> otherSlabs = UnionBoxes(boxes);
+        transpose(otherSlabs);
+        boxes = otherSlabs.size() < slabs.size() ? move(otherSlabs) : move(slabs);
+        return;
+    }
+
+    // work on coordinate ranks
+    std::vector<T> locs[2];
+    for (const auto& box : slabs) {
+        for (int d = 0; d < 2; ++d) {
+            locs[d].push_back(box[d].low);
+            locs[d].push_back(box[d].high);
+        }
+    }
+    for (int d = 0; d < 2; ++d) {
+        std::sort(locs[d].begin(), locs[d].end());
+        locs[d].erase(std::unique(locs[d].begin(), locs[d].end()), locs[d].end());
+    }
+    auto rank = [&](int d, T loc) { return std::lower_bound(locs[d].begin(), locs[d].end(), loc) - locs[d].begin(); };
+    std::vector<BoxT<int>> rankBoxes;
+    for (const auto& box : slabs) {
+        rankBoxes.emplace_back(rank(0, box.lx()), rank(1, box.ly()), rank(0, box.hx()), rank(1, box.hy()));
+    }
+    auto pieces = MinRectPartitioner().Run(rankBoxes);
+    boxes.clear();
+    for (const auto& piece : pieces) {
+        boxes.emplace_back(locs[0][piece.lx()], locs[1][piece.ly()], locs[0][piece.hx()], locs[1][piece.hy()]);
+    }
+}
+
+}  // namespace utils
@@ -0,0 +1,328 @@
+//
+// Rectilinear polygon (outer ring with holes)
+// 1. area/perimeter in O(n) (wide type, exact for integers)
+// 2. O(log n) point-in-polygon on a slab decomposition built once in the constructor, and a parallel batch version
+// 3. conversion to disjoint boxes (the slabs stitched by MergeRects) and from a box set (x sweep of the union)
+//
+
+#pragma once
+
+#include <tuple>
+
+#include "box_set.h"
+#include "parallel.h"
+
+namespace utils {
+
+template <typename T>
+class RectilinearPolygonT {
+public:
+    RectilinearPolygonT() = default;
+    // rings of alternating horizontal/vertical edges in either orientation (outer is stored counter-clockwise and
+    // holes clockwise)
+    RectilinearPolygonT(std::vector<PointT<T>> outerRing, std::vector<std::vector<PointT<T>>> holeRings = {})
+        : _outer(std::move(outerRing)), _holes(std::move(holeRings)) {
+        if (SignedArea(_outer) < 0) std::reverse(_outer.begin(), _outer.end());
+        for (auto& hole : _holes) {
+            if (SignedArea(hole) > 0) std::reverse(hole.begin(), hole.end());
+        }
+        BuildSlabs();
+    }
+
+    const std::vector<PointT<T>>& outer() const { return _outer; }
+    const std::vector<std::vector<PointT<T>>>& holes() const { return _holes; }
+    size_t numVertices() const {
+        size_t num = _outer.size();
+        for (const auto& hole : _holes) num += hole.size();
+        return num;
+    }
+    BoxT<T> bound() const {
+        BoxT<T> box;
+        for (const auto& pt : _outer) box.Update(pt);
+        return box;
+    }
+
+    WideT<T> area() const {
+        WideT<T> result = SignedArea(_outer);
+        for (const auto& hole : _holes) result += SignedArea(hole);  // negative
+        return result;
+    }
+    WideT<T> perimeter() const {
+        WideT<T> result = Perimeter(_outer);
+        for (const auto& hole : _holes) result += Perimeter(hole);
+        return result;
+    }
+
+    // Whether pt is in the closed polygon (boundary included)
+    bool Contains(const PointT<T>& pt) const {
+        size_t i = std::upper_bound(_xs.begin(), _xs.end(), pt.x) - _xs.begin();
+        if (i == 0 || (i == _xs.size() && pt.x > _xs.back())) return false;
+        // slab i - 1 is [_xs[i - 1], _xs[i]], a point on its left boundary is also in the slab before
+        if (i < _xs.size() && IsInSlab(i - 1, pt.y)) return true;
+        return pt.x == _xs[i - 1] && i >= 2 && IsInSlab(i - 2, pt.y);
+    }
+    // Batch version, one flag per point
+    std::vector<char> BatchContains(const std::vector<PointT<T>>& pts, int numThreads = 0) const {
+        std::vector<char> flags(pts.size());
+        ParallelFor(
+            0, pts.size(), [&](size_t i) { flags[i] = Contains(pts[i]); }, numThreads, 4096);
+        return flags;
+    }
+
+    // Disjoint boxes covering the polygon (slabs stitched along x)
+    std::vector<BoxT<T>> ToBoxes() const {
+        std::vector<BoxT<T>> boxes;
+        for (size_t i = 0; i + 1 < _xs.size(); ++i) {
+            for (int k = _slabBegins[i]; k + 1 < _slabBegins[i + 1]; k += 2) {
+                boxes.emplace_back(_xs[i], _slabYs[k], _xs[i + 1], _slabYs[k + 1]);
+            }
+        }
+        if (!boxes.empty()) MergeRects(boxes, 0);
+        return boxes;
+    }
+
+    // Polygons of the union of boxes (degenerated boxes are ignored)
+    // Vertical boundary edges come from an x sweep (y ranges covered on one side only); the horizontal edges pair up
+    // their end points on each y. Polygons touching only at a corner are kept separate.
+    static std::vector<RectilinearPolygonT> FromBoxes(const std::vector<BoxT<T>>& boxes) {
+        std::vector<Edge> edges = GetVerticalBoundaries(boxes);
+
+        // link the vertical edges through the horizontal ones
+        struct Corner {
+            T y, x;
+            int side;  // 0 if the horizontal edge is on the left
+            int edge;
+            bool isEnd;
+        };
+        std::vector<Corner> corners;
+        corners.reserve(edges.size() * 2);
+        for (int i = 0; i < static_cast<int>(edges.size()); ++i) {
+            const auto& e = edges[i];
+            corners.push_back({e.isUp ? e.lo : e.hi, e.x, e.isUp ? 0 : 1, i, false});
+            corners.push_back({e.isUp ? e.hi : e.lo, e.x, e.isUp ? 0 : 1, i, true});
+        }
+        std::sort(corners.begin(), corners.end(), [](const Corner& lhs, const Corner& rhs) {
+            return std::tie(lhs.y, lhs.x, lhs.side) < std::tie(rhs.y, rhs.x, rhs.side);
+        });
+        std::vector<int> next(edges.size(), -1);
+        for (size_t i = 0; i + 1 < corners.size(); i += 2) {
+            const auto& lhs = corners[i];
+            const auto& rhs = corners[i + 1];
+            if (lhs.isEnd) {
+                next[lhs.edge] = rhs.edge;
+            } else {
+                next[rhs.edge] = lhs.edge;
+            }
+        }
+
+        // trace rings, counter-clockwise ones are outer rings
+        std::vector<std::vector<PointT<T>>> outers, holes;
+        std::vector<int> holeEdges;  // an edge of each hole
+        std::vector<char> isVisited(edges.size(), false);
+        for (int i = 0; i < static_cast<int>(edges.size()); ++i) {
+            if (isVisited[i]) continue;
+            std::vector<PointT<T>> ring;
+            for (int e = i; e >= 0 && !isVisited[e]; e = next[e]) {
+                isVisited[e] = true;
+                ring.emplace_back(edges[e].x, edges[e].isUp ? edges[e].lo : edges[e].hi);
+                ring.emplace_back(edges[e].x, edges[e].isUp ? edges[e].hi : edges[e].lo);
+            }
+            if (SignedArea(ring) > 0) {
+                outers.push_back(std::move(ring));
+            } else {
+                holes.push_back(std::move(ring));
+                holeEdges.push_back(i);
+            }
+        }
+
+        // assign each hole to the smallest outer ring containing the interior right beside one of its edges
+        std::vector<BoxT<T>> outerBounds(outers.size());
+        std::vector<WideT<T>> outerAreas(outers.size());
+        for (size_t i = 0; i < outers.size(); ++i) {
+            for (const auto& pt : outers[i]) outerBounds[i].Update(pt);
+            outerAreas[i] = SignedArea(outers[i]);
+        }
+        std::vector<std::vector<std::vector<PointT<T>>>> outerHoles(outers.size());
+        for (size_t h = 0; h < holes.size(); ++h) {
+            const auto& e = edges[holeEdges[h]];
+            int best = -1;
+            for (size_t i = 0; i < outers.size(); ++i) {
+                const auto& bound = outerBounds[i];
+                if (e.x < bound.lx() || e.x > bound.hx() || e.lo < bound.ly() || e.hi > bound.hy()) continue;
+                if (best >= 0 && outerAreas[i] >= outerAreas[best]) continue;
+                if (IsBesideInRing(outers[i], e)) best = i;
+            }
+            if (best >= 0) outerHoles[best].push_back(std::move(holes[h]));
+        }
+
+        std::vector<RectilinearPolygonT> polygons;
+        polygons.reserve(outers.size());
+        for (size_t i = 0; i < outers.size(); ++i) {
+            polygons.emplace_back(std::move(outers[i]), std::move(outerHoles[i]));
+        }
+        return polygons;
+    }
+
+private:
+    std::vector<PointT<T>> _outer;
+    std::vector<std::vector<PointT<T>>> _holes;
+
+    // slab decomposition: slab i is [_xs[i], _xs[i + 1]], crossed by the horizontal edges at sorted y's
+    // _slabYs[_slabBegins[i], _slabBegins[i + 1]), inside between y's 2k and 2k + 1
+    std::vector<T> _xs;
+    std::vector<int> _slabBegins;
+    std::vector<T> _slabYs;
+
+    struct Edge {
+        T x, lo, hi;
+        bool isUp;  // upwards with the interior on the left, or downwards with the interior on the right
+    };
+
+    static WideT<T> SignedArea(const std::vector<PointT<T>>& ring) {
+        WideT<T> result = 0;
+        for (size_t i = 0; i < ring.size(); ++i) {
+            const auto& cur = ring[i];
+            const auto& nxt = ring[i + 1 == ring.size() ? 0 : i + 1];
+            result -= (WideT<T>(nxt.x) - cur.x) * (WideT<T>(cur.y) - ring[0].y);
+        }
+        return result;
+    }
+    static WideT<T> Perimeter(const std::vector<PointT<T>>& ring) {
+        WideT<T> result = 0;
+        for (size_t i = 0; i < ring.size(); ++i) {
+            const auto& cur = ring[i];
+            const auto& nxt = ring[i + 1 == ring.size() ? 0 : i + 1];
+            WideT<T> dx = WideT<T>(nxt.x) - cur.x, dy = WideT<T>(nxt.y) - cur.y;
+            result += (dx < 0 ? -dx : dx) + (dy < 0 ? -dy : dy);
+        }
+        return result;
+    }
+
+    void BuildSlabs() {
+        _xs.clear();
+        auto forEachRing = [&](auto&& func) {
+            func(_outer);
+            for (const auto& hole : _holes) func(hole);
+        };
+        forEachRing([&](const std::vector<PointT<T>>& ring) {
+            for (const auto& pt : ring) _xs.push_back(pt.x);
+        });
+        std::sort(_xs.begin(), _xs.end());
+        _xs.erase(std::unique(_xs.begin(), _xs.end()), _xs.end());
+
+        // horizontal edges -> slab ranges, counted and then filled (CSR)
+        auto forEachSlabOfEdge = [&](auto&& func) {
+            forEachRing([&](const std::vector<PointT<T>>& ring) {
+                for (size_t i = 0; i < ring.size(); ++i) {
+                    const auto& cur = ring[i];
+                    const auto& nxt = ring[i + 1 == ring.size() ? 0 : i + 1];
+                    if (cur.y != nxt.y || cur.x == nxt.x) continue;
+                    size_t begin = std::lower_bound(_xs.begin(), _xs.end(), std::min(cur.x, nxt.x)) - _xs.begin();
+                    size_t end = std::lower_bound(_xs.begin(), _xs.end(), std::max(cur.x, nxt.x)) - _xs.begin();
+                    for (size_t s = begin; s < end; ++s) func(s, cur.y);
+                }
+            });
+        };
+        std::vector<int> counts(_xs.size() + 1, 0);
+        forEachSlabOfEdge([&](size_t s, T) { ++counts[s + 1]; });
+        for (size_t i = 1; i < counts.size(); ++i) counts[i] += counts[i - 1];
+        _slabBegins = counts;
+        _slabYs.resize(counts.back());
+        forEachSlabOfEdge([&](size_t s, T y) { _slabYs[counts[s]++] = y; });
+        for (size_t s = 0; s + 1 < _slabBegins.size(); ++s) {
+            std::sort(_slabYs.begin() + _slabBegins[s], _slabYs.begin() + _slabBegins[s + 1]);
+        }
+    }
+
+    bool IsInSlab(size_t slab, T y) const {
+        auto begin = _slabYs.begin() + _slabBegins[slab], end = _slabYs.begin() + _slabBegins[slab + 1];
+        auto it = std::upper_bound(begin, end, y);
+        return (it - begin) % 2 == 1 || (it != begin && *(it - 1) == y);
+    }
+
+    // vertical boundary edges of the union of boxes, maximal and directed with the interior on the left
+    static std::vector<Edge> GetVerticalBoundaries(const std::vector<BoxT<T>>& boxes) {
+        struct Event {
+            T x, lo, hi;
+            int delta;
+        };
+        std::vector<Event> events;
+        std::vector<T> ys;
+        for (const auto& box : boxes) {
+            if (!box.IsStrictValid()) continue;
+            events.push_back({box.lx(), box.ly(), box.hy(), 1});
+            events.push_back({box.hx(), box.ly(), box.hy(), -1});
+            ys.push_back(box.ly());
+            ys.push_back(box.hy());
+        }
+        std::sort(events.begin(), events.end(), [](const Event& lhs, const Event& rhs) { return lhs.x < rhs.x; });
+        CoverageTreeT<T> tree(move(ys));
+
+        std::vector<Edge> edges;
+        std::vector<std::pair<T, T>> ranges, mergedRanges;
+        std::vector<IntervalT<T>> before, after;
+        auto collectRuns = [&](std::vector<IntervalT<T>>& runs) {
+            runs.clear();
+            for (const auto& range : mergedRanges) {
+                tree.ForEachCoveredRun(range.first, range.second, [&](T lo, T hi) { runs.emplace_back(lo, hi); });
+            }
+        };
+        // lhs minus rhs (both sorted and disjoint)
+        auto subtract = [&](const std::vector<IntervalT<T>>& lhs,
+                            const std::vector<IntervalT<T>>& rhs,
+                            T x,
+                            bool isUp) {
+            size_t j = 0;
+            for (const auto& run : lhs) {
+                T lo = run.low;
+                while (j < rhs.size() && rhs[j].high <= lo) ++j;
+                for (size_t k = j; k < rhs.size() && rhs[k].low < run.high; ++k) {
+                    if (rhs[k].low > lo) edges.push_back({x, lo, rhs[k].low, isUp});
+                    lo = std::max(lo, rhs[k].high);
+                }
+                if (lo < run.high) edges.push_back({x, lo, run.high, isUp});
+            }
+        };
+        for (size_t i = 0; i < events.size();) {
+            T x = events[i].x;
+            size_t end = i;
+            ranges.clear();
+            for (; end < events.size() && events[end].x == x; ++end) {
+                ranges.emplace_back(events[end].lo, events[end].hi);
+            }
+            std::sort(ranges.begin(), ranges.end());
+            mergedRanges.clear();
+            for (const auto& range : ranges) {
+                if (!mergedRanges.empty() && range.first <= mergedRanges.back().second) {
+                    mergedRanges.back().second = std::max(mergedRanges.back().second, range.second);
+                } else {
+                    mergedRanges.push_back(range);
+                }
+            }
+            collectRuns(before);
+            for (; i < end; ++i) tree.Add(events[i].lo, events[i].hi, events[i].delta);
+            collectRuns(after);
+            subtract(before, after, x, true);   // covered on the left only
+            subtract(after, before, x, false);  // covered on the right only
+        }
+        return edges;
+    }
+
+    // whether the interior right beside the middle of (the ring's own) edge e is inside ring, by ray casting to +x
+    static bool IsBesideInRing(const std::vector<PointT<T>>& ring, const Edge& e) {
+        WideT<T> y2 = WideT<T>(e.lo) + e.hi;  // doubled y of the ray
+        bool isInside = false;
+        for (size_t i = 0; i < ring.size(); ++i) {
+            const auto& cur = ring[i];
+            const auto& nxt = ring[i + 1 == ring.size() ? 0 : i + 1];
+            if (cur.x != nxt.x) continue;
+            // the ray starts just left of e.x if the interior is on the left (isUp), otherwise just right of it
+            if (cur.x < e.x || (cur.x == e.x && !e.isUp)) continue;
+            T lo = std::min(cur.y, nxt.y), hi = std::max(cur.y, nxt.y);
+            if (2 * WideT<T>(lo) <= y2 && y2 < 2 * WideT<T>(hi)) isInside = !isInside;
+        }
+        return isInside;
+    }
+};
+
+}  // namespace utils
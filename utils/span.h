@@ -0,0 +1,43 @@
+//
+// Non-owning view over a contiguous sequence (std::span when available)
+//
+
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#if __cplusplus >= 202002L
+#include <span>
+#endif
+
+namespace utils {
+
+#if __cplusplus >= 202002L
+template <typename T>
+using span = std::span<T>;
+#else
+template <typename T>
+class span {
+public:
+    span() = default;
+    span(T* data, size_t size) : _data(data), _size(size) {}
+    template <typename Container,
+              typename = std::enable_if_t<std::is_convertible<decltype(std::declval<Container&>().data()), T*>::value>>
+    span(Container& container) : _data(container.data()), _size(container.size()) {}
+
+    T* data() const { return _data; }
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+    T& operator[](size_t i) const { return _data[i]; }
+    T* begin() const { return _data; }
+    T* end() const { return _data + _size; }
+
+private:
+    T* _data = nullptr;
+    size_t _size = 0;
+};
+#endif
+
+}  // namespace utils
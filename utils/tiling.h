@@ -0,0 +1,171 @@
+//
+// Tiled parallel execution of local geometry operations on a box set
+// The region is cut into a grid of tiles; every tile sees the boxes intersecting its core expanded by a halo, clipped
+// to that expanded region, so local operations (slicing, booleans, spacing checks within the halo) can run on tiles
+// independently. Tiles are scheduled dynamically on the worker threads of ParallelFor.
+// 1. RunTiles: per tile results of an arbitrary operation
+// 2. RunTilesAndStitch: box outputs are clipped to the tile cores and stitched across tile borders with MergeRects
+// 3. TiledSlicePolygons/TiledUnionArea: SlicePolygons and UnionArea through the tiles
+//
+// Usage:
+//     TilingT<int> tiling(bound, 8, 8, spacing);
+//     auto violations = RunTiles(boxes, tiling, [&](int tile, const auto& tileBoxes, const auto& boxIdxs) { ... });
+//
+
+#pragma once
+
+#include "box_set.h"
+#include "parallel.h"
+
+namespace utils {
+
+// Uniform grid of numTilesX x numTilesY tiles over region, with a halo around each of them
+template <typename T>
+class TilingT {
+public:
+    TilingT(const BoxT<T>& region, int numTilesX, int numTilesY, T halo = 0) : _halo(halo) {
+        int numTiles[2] = {std::max(numTilesX, 1), std::max(numTilesY, 1)};
+        for (int d = 0; d < 2; ++d) {
+            for (int i = 0; i <= numTiles[d]; ++i) {
+                _borders[d].push_back(region[d].low + static_cast<T>(WideT<T>(region[d].range()) * i / numTiles[d]));
+            }
+            _borders[d].back() = region[d].high;
+        }
+    }
+
+    int numTilesX() const { return _borders[0].size() - 1; }
+    int numTilesY() const { return _borders[1].size() - 1; }
+    int numTiles() const { return numTilesX() * numTilesY(); }
+    T halo() const { return _halo; }
+    // tile cores partition the region (neighbors share their borders), tile = ty * numTilesX() + tx
+    BoxT<T> core(int tile) const {
+        int tx = tile % numTilesX(), ty = tile / numTilesX();
+        return {_borders[0][tx], _borders[1][ty], _borders[0][tx + 1], _borders[1][ty + 1]};
+    }
+    BoxT<T> haloRegion(int tile) const {
+        BoxT<T> box = core(tile);
+        box.Set(box.lx() - _halo, box.ly() - _halo, box.hx() + _halo, box.hy() + _halo);
+        return box;
+    }
+
+    // boxes intersecting each halo region (CSR: boxes of tile i are boxIdxs[tileBegins[i], tileBegins[i + 1]))
+    void Assign(const std::vector<BoxT<T>>& boxes, std::vector<int>& tileBegins, std::vector<int>& boxIdxs) const {
+        std::vector<std::pair<int, int>> entries;  // (tile, box idx)
+        for (int i = 0; i < static_cast<int>(boxes.size()); ++i) {
+            if (!boxes[i].IsValid()) continue;
+            int begins[2], ends[2];
+            for (int d = 0; d < 2; ++d) {
+                // tiles k with borders[k] - halo <= high and borders[k + 1] + halo >= low
+                const auto& borders = _borders[d];
+                begins[d] = std::lower_bound(borders.begin(), borders.end(), boxes[i][d].low - _halo) - borders.begin();
+                ends[d] = std::upper_bound(borders.begin(), borders.end(), boxes[i][d].high + _halo) - borders.begin();
+                begins[d] = std::max(begins[d] - 1, 0);
+                ends[d] = std::min<int>(ends[d], borders.size() - 1);
+            }
+            for (int ty = begins[1]; ty < ends[1]; ++ty) {
+                for (int tx = begins[0]; tx < ends[0]; ++tx) entries.emplace_back(ty * numTilesX() + tx, i);
+            }
+        }
+        std::sort(entries.begin(), entries.end());
+        tileBegins.assign(numTiles() + 1, 0);
+        boxIdxs.resize(entries.size());
+        for (size_t k = 0; k < entries.size(); ++k) {
+            ++tileBegins[entries[k].first + 1];
+            boxIdxs[k] = entries[k].second;
+        }
+        for (int tile = 0; tile < numTiles(); ++tile) tileBegins[tile + 1] += tileBegins[tile];
+    }
+
+private:
+    std::vector<T> _borders[2];  // of x and y
+    T _halo;
+};
+
+// op(tile, tileBoxes, boxIdxs) on every tile in parallel, return the results by tile
+// tileBoxes are the boxes intersecting the halo region clipped to it, boxIdxs their indices in boxes.
+template <typename T, typename Op>
+auto RunTiles(const std::vector<BoxT<T>>& boxes, const TilingT<T>& tiling, const Op& op, int numThreads = 0)
+    -> std::vector<decltype(op(0, std::vector<BoxT<T>>(), std::vector<int>()))> {
+    std::vector<int> tileBegins, boxIdxs;
+    tiling.Assign(boxes, tileBegins, boxIdxs);
+    std::vector<decltype(op(0, std::vector<BoxT<T>>(), std::vector<int>()))> results(tiling.numTiles());
+    ParallelFor(
+        0,
+        tiling.numTiles(),
+        [&](size_t tile) {
+            BoxT<T> region = tiling.haloRegion(tile);
+            std::vector<int> tileIdxs(boxIdxs.begin() + tileBegins[tile], boxIdxs.begin() + tileBegins[tile + 1]);
+            std::vector<BoxT<T>> tileBoxes;
+            tileBoxes.reserve(tileIdxs.size());
+            for (int i : tileIdxs) tileBoxes.push_back(boxes[i].IntersectWith(region));
+            results[tile] = op(static_cast<int>(tile), tileBoxes, tileIdxs);
+        },
+        numThreads,
+        1);
+    return results;
+}
+
+// op(tile, tileBoxes, boxIdxs) returning boxes on every tile, the outputs are clipped to the tile cores (degenerated
+// pieces are dropped), then pieces are stitched across the tile borders along x and then y with MergeRects
+template <typename T, typename Op>
+std::vector<BoxT<T>> RunTilesAndStitch(const std::vector<BoxT<T>>& boxes,
+                                       const TilingT<T>& tiling,
+                                       const Op& op,
+                                       int numThreads = 0) {
+    auto tileResults = RunTiles(
+        boxes,
+        tiling,
+        [&](int tile, const std::vector<BoxT<T>>& tileBoxes, const std::vector<int>& boxIdxs) {
+            std::vector<BoxT<T>> clipped;
+            BoxT<T> core = tiling.core(tile);
+            for (const auto& box : op(tile, tileBoxes, boxIdxs)) {
+                BoxT<T> piece = box.IntersectWith(core);
+                if (piece.IsStrictValid()) clipped.push_back(piece);
+            }
+            return clipped;
+        },
+        numThreads);
+    std::vector<BoxT<T>> result;
+    for (const auto& tileResult : tileResults) result.insert(result.end(), tileResult.begin(), tileResult.end());
+    if (!result.empty() && tiling.numTilesX() > 1) MergeRects(result, 0);
+    if (!result.empty() && tiling.numTilesY() > 1) MergeRects(result, 1);
+    return result;
+}
+
+// SlicePolygons (in place) tile by tile
+// The result equals that of SlicePolygons if the tiles span the region along sliceDir (e.g., numTilesY = 1 for
+// sliceDir = 1), otherwise it is an equivalent set of disjoint boxes with extra cuts at the tile borders.
+template <typename T>
+void TiledSlicePolygons(std::vector<BoxT<T>>& boxes, int sliceDir, const TilingT<T>& tiling, int numThreads = 0) {
+    boxes = RunTilesAndStitch(
+        boxes,
+        tiling,
+        [&](int, std::vector<BoxT<T>> tileBoxes, const std::vector<int>&) {
+            tileBoxes.erase(std::remove_if(tileBoxes.begin(),
+                                           tileBoxes.end(),
+                                           [](const BoxT<T>& box) { return !box.IsStrictValid(); }),
+                            tileBoxes.end());
+            SlicePolygons(tileBoxes, sliceDir);
+            return tileBoxes;
+        },
+        numThreads);
+}
+
+// UnionArea as the sum over tiles of the union area within the tile cores (exact, no stitching needed)
+template <typename T>
+WideT<T> TiledUnionArea(const std::vector<BoxT<T>>& boxes, const TilingT<T>& tiling, int numThreads = 0) {
+    auto tileAreas = RunTiles(
+        boxes,
+        tiling,
+        [&](int tile, std::vector<BoxT<T>> tileBoxes, const std::vector<int>&) {
+            BoxT<T> core = tiling.core(tile);
+            for (auto& box : tileBoxes) box = box.IntersectWith(core);
+            return UnionArea(tileBoxes);
+        },
+        numThreads);
+    WideT<T> area = 0;
+    for (const auto& tileArea : tileAreas) area += tileArea;
+    return area;
+}
+
+}  // namespace utils
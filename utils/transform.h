@@ -0,0 +1,185 @@
+//
+// Orientation and placement transforms of points and boxes (e.g., instantiating cell masters)
+// Orient follows the LEF/DEF orientations: N/W/S/E rotate by 0/90/180/270 degrees counter-clockwise, and their
+// flipped versions mirror x first (FN = MY, FS = MX, FE = MY90, FW = MX90). TransformT is an orientation followed
+// by a translation; transforms compose and invert, and transformed boxes are normalized (lx <= hx, ly <= hy).
+// Batch application over spans uses SSE2 for int coordinates (a whole BoxT<int> or two PointT<int> per vector: one
+// shuffle, a conditional negation and one add), and PlaceInstances fills the shapes of many instances in parallel.
+//
+// Usage:
+//     auto trans = TransformT<int>::Placement(Orient::FS, loc, masterBound);
+//     trans.Apply(masterShapes, instShapes);
+//
+
+#pragma once
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#include <cstdint>
+
+#include "geo.h"
+#include "parallel.h"
+#include "span.h"
+
+namespace utils {
+
+// code = flip * 4 + number of 90-degree counter-clockwise rotations; pt -> Rot^r(Flip^f(pt)), Flip: (x, y) -> (-x, y)
+enum class Orient : uint8_t { N, W, S, E, FN, FE, FS, FW };
+
+// outer after inner
+constexpr Orient Compose(Orient outer, Orient inner) noexcept {
+    // Rot^r1 Flip^f1 Rot^r2 Flip^f2 = Rot^(r1 +/- r2) Flip^(f1 ^ f2) as Flip Rot = Rot^-1 Flip
+    int o = static_cast<int>(outer), i = static_cast<int>(inner);
+    int rot = ((o & 3) + ((o & 4) ? 4 - (i & 3) : (i & 3))) & 3;
+    return static_cast<Orient>(((o ^ i) & 4) | rot);
+}
+constexpr Orient Inverse(Orient orient) noexcept {
+    int o = static_cast<int>(orient);
+    return (o & 4) ? orient : static_cast<Orient>((4 - o) & 3);  // flipped ones are involutions
+}
+// whether x and y are swapped (90/270 degrees)
+constexpr bool IsSwapped(Orient orient) noexcept { return static_cast<int>(orient) & 1; }
+// pt -> (xSign * (swapped ? y : x), ySign * (swapped ? x : y))
+// (bit k of the masks: sign of orientation code k is +1)
+constexpr int XSign(Orient orient) noexcept { return (0xc9 >> static_cast<int>(orient) & 1) ? 1 : -1; }
+constexpr int YSign(Orient orient) noexcept { return (0x93 >> static_cast<int>(orient) & 1) ? 1 : -1; }
+
+template <typename T>
+class TransformT {
+public:
+    Orient orient = Orient::N;
+    PointT<T> offset = {0, 0};
+
+    constexpr TransformT() = default;
+    constexpr TransformT(Orient orientVal, const PointT<T>& offsetVal) : orient(orientVal), offset(offsetVal) {}
+    constexpr explicit TransformT(const PointT<T>& offsetVal) : offset(offsetVal) {}
+
+    // orient a master with bounding box masterBound, and move its oriented bound to have lower left corner loc (DEF)
+    static constexpr TransformT Placement(Orient orient, const PointT<T>& loc, const BoxT<T>& masterBound) {
+        TransformT trans(orient, {0, 0});
+        BoxT<T> bound = trans(masterBound);
+        trans.offset = {loc.x - bound.lx(), loc.y - bound.ly()};
+        return trans;
+    }
+
+    constexpr PointT<T> operator()(const PointT<T>& pt) const {
+        T x = IsSwapped(orient) ? pt.y : pt.x, y = IsSwapped(orient) ? pt.x : pt.y;
+        return {XSign(orient) * x + offset.x, YSign(orient) * y + offset.y};
+    }
+    // normalized, i.e., a negated coordinate swaps the low and high ends
+    constexpr BoxT<T> operator()(const BoxT<T>& box) const {
+        IntervalT<T> x = IsSwapped(orient) ? box.y : box.x, y = IsSwapped(orient) ? box.x : box.y;
+        return {(XSign(orient) > 0 ? x.low : -x.high) + offset.x,
+                (YSign(orient) > 0 ? y.low : -y.high) + offset.y,
+                (XSign(orient) > 0 ? x.high : -x.low) + offset.x,
+                (YSign(orient) > 0 ? y.high : -y.low) + offset.y};
+    }
+
+    // (*this * rhs)(pt) = (*this)(rhs(pt))
+    constexpr TransformT operator*(const TransformT& rhs) const {
+        PointT<T> shifted = (*this)(rhs.offset);
+        return {Compose(orient, rhs.orient), shifted};
+    }
+    constexpr TransformT Inverse() const {
+        TransformT inv(utils::Inverse(orient), {0, 0});
+        PointT<T> back = inv(offset);
+        inv.offset = {-back.x, -back.y};
+        return inv;
+    }
+    constexpr bool operator==(const TransformT& rhs) const { return orient == rhs.orient && offset == rhs.offset; }
+    constexpr bool operator!=(const TransformT& rhs) const { return !(*this == rhs); }
+
+    // out[i] = (*this)(in[i]) (out.size() >= in.size(), in and out may be the same)
+    void Apply(span<const PointT<T>> in, span<PointT<T>> out) const {
+        TransformBatch(*this, in.data(), out.data(), in.size());
+    }
+    void Apply(span<const BoxT<T>> in, span<BoxT<T>> out) const {
+        TransformBatch(*this, in.data(), out.data(), in.size());
+    }
+    void Apply(std::vector<PointT<T>>& pts) const { TransformBatch(*this, pts.data(), pts.data(), pts.size()); }
+    void Apply(std::vector<BoxT<T>>& boxes) const { TransformBatch(*this, boxes.data(), boxes.data(), boxes.size()); }
+};
+
+// out[i] = trans(in[i]) (in and out may be the same)
+template <typename T, typename Geo>
+void TransformBatch(const TransformT<T>& trans, const Geo* in, Geo* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = trans(in[i]);
+}
+#if defined(__SSE2__) || defined(_M_X64)
+// lanes of BoxT<int> are (lx, hx, ly, hy): a lane takes the low/high end of x or y, negated if its sign is -1
+constexpr int BoxShuffle(Orient o) {
+    int xBase = IsSwapped(o) ? 2 : 0, yBase = 2 - xBase, xNeg = XSign(o) < 0, yNeg = YSign(o) < 0;
+    return (xBase + xNeg) | (xBase + !xNeg) << 2 | (yBase + yNeg) << 4 | (yBase + !yNeg) << 6;
+}
+// lanes of two PointT<int> are (x0, y0, x1, y1)
+constexpr int PointShuffle(Orient o) { return IsSwapped(o) ? 0xb1 : 0xe4; }
+
+template <int shuffle>
+inline void TransformVecs(const int* in, int* out, size_t numVecs, __m128i negMask, __m128i offsetVec) {
+    for (size_t i = 0; i < numVecs; ++i) {
+        __m128i val = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in) + i), shuffle);
+        val = _mm_sub_epi32(_mm_xor_si128(val, negMask), negMask);  // -v = ~v + 1
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out) + i, _mm_add_epi32(val, offsetVec));
+    }
+}
+// _mm_shuffle_epi32 needs an immediate, so dispatch on the orientation
+#define UTILS_TRANSFORM_CASE(o, shuffleFunc)                                           \
+    case Orient::o:                                                                   \
+        TransformVecs<shuffleFunc(Orient::o)>(in, out, numVecs, negMask, offsetVec); \
+        break;
+#define UTILS_TRANSFORM_SWITCH(orient, shuffleFunc) \
+    switch (orient) {                               \
+        UTILS_TRANSFORM_CASE(N, shuffleFunc)        \
+        UTILS_TRANSFORM_CASE(W, shuffleFunc)        \
+        UTILS_TRANSFORM_CASE(S, shuffleFunc)        \
+        UTILS_TRANSFORM_CASE(E, shuffleFunc)        \
+        UTILS_TRANSFORM_CASE(FN, shuffleFunc)       \
+        UTILS_TRANSFORM_CASE(FE, shuffleFunc)       \
+        UTILS_TRANSFORM_CASE(FS, shuffleFunc)       \
+        UTILS_TRANSFORM_CASE(FW, shuffleFunc)       \
+    }
+inline void TransformBatch(const TransformT<int>& trans, const BoxT<int>* boxes, BoxT<int>* outBoxes, size_t n) {
+    int xNeg = XSign(trans.orient) < 0 ? -1 : 0, yNeg = YSign(trans.orient) < 0 ? -1 : 0;
+    __m128i negMask = _mm_setr_epi32(xNeg, xNeg, yNeg, yNeg);
+    __m128i offsetVec = _mm_setr_epi32(trans.offset.x, trans.offset.x, trans.offset.y, trans.offset.y);
+    const int* in = reinterpret_cast<const int*>(boxes);
+    int* out = reinterpret_cast<int*>(outBoxes);
+    size_t numVecs = n;
+    UTILS_TRANSFORM_SWITCH(trans.orient, BoxShuffle)
+}
+inline void TransformBatch(const TransformT<int>& trans, const PointT<int>* pts, PointT<int>* outPts, size_t n) {
+    int xNeg = XSign(trans.orient) < 0 ? -1 : 0, yNeg = YSign(trans.orient) < 0 ? -1 : 0;
+    __m128i negMask = _mm_setr_epi32(xNeg, yNeg, xNeg, yNeg);
+    __m128i offsetVec = _mm_setr_epi32(trans.offset.x, trans.offset.y, trans.offset.x, trans.offset.y);
+    const int* in = reinterpret_cast<const int*>(pts);
+    int* out = reinterpret_cast<int*>(outPts);
+    size_t numVecs = n / 2;
+    UTILS_TRANSFORM_SWITCH(trans.orient, PointShuffle)
+    if (n % 2) outPts[n - 1] = trans(pts[n - 1]);
+}
+#undef UTILS_TRANSFORM_SWITCH
+#undef UTILS_TRANSFORM_CASE
+#endif
+
+// Shapes of instances: out[i * shapes.size() + k] = transforms[i](shapes[k]), out is resized
+template <typename T, typename Geo>
+void PlaceInstances(const std::vector<Geo>& shapes,
+                    const std::vector<TransformT<T>>& transforms,
+                    std::vector<Geo>& out,
+                    int numThreads = 0) {
+    size_t numShapes = shapes.size();
+    out.resize(numShapes * transforms.size());
+    if (numShapes == 0) return;
+    ParallelFor(
+        0,
+        transforms.size(),
+        [&](size_t i) {
+            TransformBatch(transforms[i], shapes.data(), out.data() + i * numShapes, numShapes);
+        },
+        numThreads,
+        std::max<size_t>(1, 16384 / numShapes));
+}
+
+}  // namespace utils
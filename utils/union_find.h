@@ -0,0 +1,62 @@
+//
+// Union-find (disjoint set) that is safe to use from multiple threads
+// Union() and Find() are lock-free: roots are linked with compare-and-swap (larger index under smaller index),
+// and paths are halved along the way.
+//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <utility>
+
+namespace utils {
+
+class UnionFind {
+public:
+    UnionFind(size_t num = 0) { Init(num); }
+
+    // reset to num singleton sets
+    void Init(size_t num) {
+        _size = num;
+        _parent.reset(new std::atomic<int>[num]);
+        for (size_t i = 0; i < num; ++i) _parent[i].store(static_cast<int>(i), std::memory_order_relaxed);
+    }
+    size_t size() const { return _size; }
+
+    // representative (root) of the set containing i
+    int Find(int i) {
+        while (true) {
+            int parent = _parent[i].load(std::memory_order_relaxed);
+            if (parent == i) return i;
+            int grandParent = _parent[parent].load(std::memory_order_relaxed);
+            if (parent != grandParent) _parent[i].compare_exchange_weak(parent, grandParent, std::memory_order_relaxed);
+            i = grandParent;
+        }
+    }
+    // merge the sets containing i and j, return false if they were already merged
+    bool Union(int i, int j) {
+        while (true) {
+            i = Find(i);
+            j = Find(j);
+            if (i == j) return false;
+            if (i < j) std::swap(i, j);
+            int expected = i;
+            if (_parent[i].compare_exchange_strong(expected, j, std::memory_order_relaxed)) return true;
+        }
+    }
+    bool IsSameSet(int i, int j) {
+        while (true) {
+            i = Find(i);
+            j = Find(j);
+            if (i == j) return true;
+            if (_parent[i].load(std::memory_order_relaxed) == i) return false;  // i is still a root
+        }
+    }
+
+private:
+    std::unique_ptr<std::atomic<int>[]> _parent;
+    size_t _size = 0;
+};
+
+}  // namespace utils
@@ -2,4 +2,28 @@
 
 #include "prettyprint.h"
 #include "geo.h"
-#include "log.h"
\ No newline at end of file
+#include "log.h"
+#include "parallel.h"
+#include "assignment.h"
+#include "bbox_tracker.h"
+#include "box_index.h"
+#include "box_expr.h"
+#include "box_set.h"
+#include "cluster.h"
+#include "connectivity.h"
+#include "containment.h"
+#include "convex_hull.h"
+#include "free_space.h"
+#include "geo_file.h"
+#include "geo_hash.h"
+#include "geo_parser.h"
+#include "hpwl.h"
+#include "interval_graph.h"
+#include "packed_rtree.h"
+#include "point_grid.h"
+#include "point_locator.h"
+#include "quadtree.h"
+#include "rect_partition.h"
+#include "rect_polygon.h"
+#include "tiling.h"
+#include "transform.h"